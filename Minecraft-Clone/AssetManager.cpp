@@ -1,12 +1,17 @@
 #include "AssetManager.h"
+#include "RenderDevice.h"
+#include "FaceFormat.h"
+#include "TextureTiles.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
 std::map<std::string, GLuint> AssetManager::assetHandles = {};
 
-GLuint AssetManager::getAssetHandle(std::string fileName) {
-	return assetHandles[fileName];
+GLuint AssetManager::getAssetHandle(const std::string& fileName) {
+	auto itr = assetHandles.find(fileName);
+	return itr != assetHandles.end() ? itr->second : 0;
 }
 
 void AssetManager::loadTexture(std::string path) {
@@ -17,62 +22,63 @@ void AssetManager::loadTexture(std::string path) {
 		return;
 	}
 
-	GLuint texId;
-	glGenTextures(1, &texId);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glGenerateMipmap(GL_TEXTURE_2D);
-
 	int width, height;
 	unsigned char* image = SOIL_load_image(path.c_str(), &width, &height, 0, SOIL_LOAD_RGB);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+	GLuint texId = RenderDevice::getInstance()->createTexture2D(width, height, image);
+	SOIL_free_image_data(image);
 
 	assetHandles.insert(std::make_pair(fileName, texId));
 }
 
-void AssetManager::loadShader(std::string handleName, std::string vertShader, std::string fragShader) {
-    std::string vertexShaderStr = loadFile("./assets/generic.vert");
-    const char* vertexShaderSrc = vertexShaderStr.c_str();
-    std::string fragmentShaderStr = loadFile("./assets/generic.frag");
-    const char* fragmentShaderSrc = fragmentShaderStr.c_str();
-
-    // Create and compile the vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSrc, 0); // length 0 means opengl will figure it out for us
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::VERTEX_SHADER::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
+void AssetManager::loadTextureArray(std::string path, int tileSize) {
+	std::string fileName = getFileName(path);
 
+	// check if we have already loaded this texture
+	if (assetHandles.find(fileName) != assetHandles.end()) {
+		return;
+	}
 
-    // Create and compile the fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSrc, 0); // length 0 means opengl will figure it out for us
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::FRAGMENT_SHADER::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
+	int width, height;
+	unsigned char* image = SOIL_load_image(path.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
+	if (image == nullptr) {
+		std::cout << "Failed to load texture at: " << path << std::endl;
+		return;
+	}
 
+	// tiles and their mip chains are built on worker threads, the device only gets the finished levels
+	std::vector<TextureTile> tiles = buildTextureTiles(image, width, height, tileSize);
+	SOIL_free_image_data(image);
+
+	if (tiles.empty()) {
+		std::cout << "No " << tileSize << "px tiles in texture: " << path << std::endl;
+		return;
+	}
+
+	RenderDevice* device = RenderDevice::getInstance();
+	int levelCount = (int)tiles[0].levels.size();
+	int layerCount = (int)tiles.size();
+
+	GLuint texId = device->createTextureArray(tileSize, layerCount, levelCount);
+
+	for (int layer = 0; layer < layerCount; layer++) {
+		for (int level = 0; level < levelCount; level++) {
+			int size = std::max(tileSize >> level, 1);
+			device->uploadTextureLayer(texId, level, layer, size, tiles[(size_t)layer].levels[(size_t)level].data());
+		}
+	}
+
+	assetHandles.insert(std::make_pair(fileName, texId));
+}
+
+void AssetManager::loadShader(std::string handleName, std::string vertShader, std::string fragShader) {
+    std::string vertexShaderStr = loadFile("./assets/generic.vert");
+    std::string fragmentShaderStr = loadFile("./assets/generic.frag");
 
-    // Link vertex and fragment shaders to a shader program
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glBindFragDataLocation(shaderProgram, 0, "fragColor");
-    glLinkProgram(shaderProgram);
-    glUseProgram(shaderProgram);
+    // the face decoders are generated from FaceFormat.h, so the shader reads what FaceData packs
+    vertexShaderStr.insert(vertexShaderStr.find('\n') + 1, getFaceFormatGlsl());
 
-    glDeleteShader(fragmentShader);
-    glDeleteShader(vertexShader);
+    // compile errors are reported by the device
+    GLuint shaderProgram = RenderDevice::getInstance()->createProgram(vertexShaderStr, fragmentShaderStr);
     
     assetHandles.insert(std::make_pair(handleName, shaderProgram));
 }
@@ -82,7 +88,7 @@ std::string AssetManager::getFileName(std::string path, bool removeExtension) {
         path.pop_back();
     }
 
-    path.erase(0, path.find_last_of('/'));
+    path.erase(0, path.find_last_of('/') + 1); // npos + 1 erases nothing
 
     if (removeExtension) {
         path.erase(path.find_last_of('.'));
@@ -6,9 +6,13 @@
 
 class AssetManager {
 public:
-	static GLuint getAssetHandle(std::string fileName);
+	// @returns The handle of a loaded asset, or 0 if there is none. Resolve handles once, not per draw.
+	static GLuint getAssetHandle(const std::string& fileName);
 
 	static void loadTexture(std::string path);
+
+	// Loads an image of square tiles as a GL_TEXTURE_2D_ARRAY, one layer per tile (row by row) with its own mip chain
+	static void loadTextureArray(std::string path, int tileSize);
 	static void loadShader(std::string handleName, std::string vertShader, std::string fragShader);
 
 private:
@@ -11,10 +11,27 @@ enum BlockType : int8_t {
 	COBBLESTONE,
 	WOODEN_PLANK,
 	WOODEN_LOG,
+	GLASS,
 
 	TYPE_COUNT
 };
 
+// @returns True if the block is see-through but not empty, its faces are drawn blended in their own pass
+constexpr bool isBlockTranslucent(BlockType t) {
+	return t == GLASS;
+}
+
+// @returns True if the block hides what is behind it
+constexpr bool isBlockOpaque(BlockType t) {
+	return t != AIR && !isBlockTranslucent(t);
+}
+
+// @returns True if the face of 'block' that touches 'neighbour' is drawn,
+// faces between two blocks of the same translucent type are hidden like opaque ones
+constexpr bool isBlockFaceVisible(BlockType block, BlockType neighbour) {
+	return block != AIR && !isBlockOpaque(neighbour) && neighbour != block;
+}
+
 // +1 to account for AIR being -1
 constexpr std::string_view BlockNames[TYPE_COUNT + 1] = {
 	"Air",
@@ -23,7 +40,8 @@ constexpr std::string_view BlockNames[TYPE_COUNT + 1] = {
 	"Stone",
 	"Cobblestone",
 	"Wooden Plank",
-	"Wooden Log"
+	"Wooden Log",
+	"Glass"
 };
 static_assert(std::ranges::all_of(BlockNames, [](const std::string_view& s) {return !s.empty(); }), "Not enough block names!");
 
@@ -56,4 +74,5 @@ constexpr uint8_t blockTextureIds[TYPE_COUNT][6] = {
 	{ 4, 4, 4, 4, 4, 4 }, // COBBLESTONE
 	{ 5, 5, 5, 5, 5, 5 }, // WOODEN PLANK
 	{ 7, 7, 7, 7, 6, 6 }, // WOODEN LOG
+	{ 8, 8, 8, 8, 8, 8 }, // GLASS
 };
\ No newline at end of file
@@ -24,6 +24,8 @@ public:
 	}
 
 	bool update(float deltaSeconds) {
+		velocity = { 0, 0, 0 };
+
 		if (moveInput == glm::vec3(0) && lookInput == glm::vec2(0)) {
 			return false;
 		}
@@ -36,6 +38,7 @@ public:
 									  (moveInput.y * forward) +
 									  (moveInput.z * up);
 			position += localMovement * deltaSeconds;
+			velocity = localMovement;
 			
 			moveInput = { 0, 0, 0 };
 		}
@@ -80,6 +83,7 @@ public:
 	const glm::mat4& getView() const { return view; }
 	const glm::vec3& getPosition() const { return position; }
 	const glm::vec3& getForwardDir() const { return forward; }
+	const glm::vec3& getVelocity() const { return velocity; }
 
 private:
 	void calculateView() {
@@ -91,6 +95,7 @@ private:
 	glm::vec3 forward = { -1, 0, 0 };
 	glm::vec3 up = { 0, 0, 1 };
 	glm::vec3 right = { 0, 0, 0 };
+	glm::vec3 velocity = { 0, 0, 0 }; // units per second, from the last update
 
 	glm::mat4 view;
 
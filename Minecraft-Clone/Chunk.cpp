@@ -5,39 +5,22 @@
 #include "WorldGenerator.h"
 #include "ChunkManager.h"
 #include "DebugClock.h"
+#include "ChunkCache.h"
 #include <set>
+#include "LodMesher.h"
+#include "DeviceUploadRing.h"
+#include "TranslucentSort.h"
+#include <cstring>
 
-void checkGLError(const char* stmt, const char* fname, int line) {
-	GLenum err = glGetError();
-	if (err != GL_NO_ERROR) {
-		printf("OpenGL error %08x, at %s:%i - for %s\n", err, fname, line, stmt);
-		exit(1);
-	}
-}
-
-#define GL_CHECK(stmt) do { \
-    stmt; \
-    checkGLError(#stmt, __FILE__, __LINE__); \
-} while (0)
-
-Chunk::Chunk(glm::vec2 _chunkIndex) :
+Chunk::Chunk(glm::vec2 _chunkIndex, const CachedChunk* cached, uint8_t _lod) :
 	blocks((size_t)chunkSize.x, std::vector<std::vector<BlockType>>((size_t)chunkSize.y, std::vector<BlockType>((size_t)chunkSize.z, BlockType::AIR)))
 {
-	startPos = glm::vec3(_chunkIndex, 0) * chunkSize;
-	chunkIndex = _chunkIndex;
-
-	DebugClock::recordTime("Start gen chunk");
-	generateChunk();
-	DebugClock::recordTime("Start gen faces");
-	generateFaces();
+	load(_chunkIndex, cached, _lod);
 }
 
 Chunk::~Chunk()
 {
-	GLuint buffers[] = {vbo, ebo, faceDataBuffer};
-	glDeleteBuffers(3, buffers);
-
-	glDeleteVertexArrays(1, &vao);
+	releaseMesh();
 
 	faceData.clear();
 	faceData.shrink_to_fit();
@@ -46,34 +29,91 @@ Chunk::~Chunk()
 	blocks.shrink_to_fit();
 }
 
-void Chunk::init()
+void Chunk::load(glm::vec2 _chunkIndex, const CachedChunk* cached, uint8_t _lod)
 {
-	DebugClock::recordTime("Start init shader vars");
-	initShaderVars();
-	DebugClock::recordTime("Finish gen chunk");
+	startPos = glm::vec3(_chunkIndex, 0) * chunkSize;
+	chunkIndex = _chunkIndex;
+	lod = _lod;
+
+	// keeps the capacity, so a recycled chunk doesn't re-allocate
+	faceData.clear();
+	indexesToChange.clear();
+	edited = (cached && cached->edited);
+	editCount = 0;
+
+	if (cached) {
+		restoreFromCache(*cached);
+	}
+	else {
+		DebugClock::recordTime("Start gen chunk");
+		generateChunk();
+		DebugClock::recordTime("Start gen faces");
+		generateFaces();
+	}
+
+	for (int s = 0; s < sectionCount; s++) {
+		computeSectionVisibility(s);
+	}
 }
 
-void Chunk::render()
+void Chunk::cacheTo(CachedChunk& out) const
 {
-	// bind the correct texture before rendering
-	glBindTexture(GL_TEXTURE_2D, AssetManager::getAssetHandle("texture-atlas"));
+	cacheBlocksTo(out);
+	out.faceData = faceData;
+}
+
+void Chunk::cacheBlocksTo(CachedChunk& out) const
+{
+	out.blockRuns.clear();
+
+	for (const auto& column : blocks) {
+		for (const auto& row : column) {
+			for (BlockType b : row) {
+				if (!out.blockRuns.empty() && out.blockRuns.back().type == b && out.blockRuns.back().length < UINT16_MAX) {
+					out.blockRuns.back().length++;
+				}
+				else {
+					out.blockRuns.push_back({ 1, b });
+				}
+			}
+		}
+	}
+
+	out.blockRuns.shrink_to_fit();
+	out.faceData.clear();
+	out.lod = lod;
+	out.edited = edited;
+}
 
-	// bind the correct chunk index
-	GLint chunkIndexLoc = glGetUniformLocation(AssetManager::getAssetHandle("generic"), "chunkIndex");
-	glUniform2f(chunkIndexLoc, chunkIndex.x, chunkIndex.y);
+void Chunk::init()
+{
+	DebugClock::recordTime("Start init shader vars");
 
-	// bind vertex array -> draw vertices -> un-bind vertex array
-	glBindVertexArray(vao);
-	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)faceData.size());
-	glBindVertexArray(0);
+	uploadMesh();
 
-	// un-bind texture
-	glBindTexture(GL_TEXTURE_2D, 0);
+	DebugClock::recordTime("Finish gen chunk");
 }
 
 void Chunk::update() {
+	// LOD faces don't map to single blocks, so re-mesh the whole chunk
+	if (!indexesToChange.empty() && lod != 0) {
+		for (auto& i : indexesToChange) {
+			blocks[i.blockIndex.x][i.blockIndex.y][i.blockIndex.z] = i.blockType;
+			computeSectionVisibility(i.blockIndex.z / sectionHeight);
+		}
+
+		editCount += (uint32_t)indexesToChange.size();
+		indexesToChange.clear();
+		faceData.clear();
+		generateFaces();
+
+		meshDirty = true;
+		return;
+	}
+
 	if (!indexesToChange.empty()) {
 		std::set<Chunk*> otherChunksToUpdate = {};
+		std::set<int> changedSections = {};
 
 		for (auto& i : indexesToChange) {
 			if (i.blockType == AIR) {
@@ -82,17 +122,120 @@ void Chunk::update() {
 			else {
 				addBlock(i);
 			}
+
+			changedSections.insert(i.blockIndex.z / sectionHeight);
+		}
+
+		// only the edited sections' connectivity can have changed
+		for (int s : changedSections) {
+			if (s >= 0 && s < sectionCount) {
+				computeSectionVisibility(s);
+			}
 		}
 
+		editCount += (uint32_t)indexesToChange.size();
 		indexesToChange.clear();
 		indexesToChange.shrink_to_fit();
 
-		reBindFaceBuffer();
+		meshDirty = true;
+	}
+}
+
+bool Chunk::swapMesh() {
+	if (!meshDirty) {
+		return false;
+	}
+
+	uploadMesh();
+	return true;
+}
+
+void Chunk::releaseMesh() {
+	if (meshRange.isValid()) {
+		ChunkManager::getInstance()->getMeshBuffer().release(meshRange);
+	}
+
+	discardStaging();
+
+	uploadedFaceCount = 0;
+	bucketStarts = {};
+	meshDirty = false;
+}
+
+bool Chunk::stageMesh(DeviceUploadRing& ring) {
+	discardStaging();
+	sortFacesByBucket();
+
+	size_t bytes = sizeof(FaceData) * faceData.size();
+	uint8_t* dst = ring.allocate(bytes, stagingRegion, stagingOffset);
+	if (dst == nullptr) {
+		return false;
+	}
+
+	memcpy(dst, faceData.data(), bytes);
+	isStaged = true;
+	return true;
+}
+
+const uint32_t Chunk::getSectionFaceCount(int section) const {
+	uint32_t count = getTranslucentFaceCount(section);
+	for (int d = 0; d < FACE_COUNT; d++) {
+		int bucket = d * sectionCount + section;
+		count += bucketStarts[bucket + 1] - bucketStarts[bucket];
+	}
+
+	return count;
+}
+
+uint32_t Chunk::sortTranslucentFaces(int section, const glm::vec3& eyePos) {
+	// edited faces aren't bucketed until they're uploaded, which sorts them again anyway
+	uint32_t faceCount = getTranslucentFaceCount(section);
+	if (faceCount == 0 || meshDirty) {
+		return 0;
+	}
+
+	glm::vec3 sectionMin = startPos + extentsMin + glm::vec3(0, 0, section * sectionHeight);
+	glm::vec3 sectionMax = sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight);
+	glm::ivec3 cell = getTranslucentSortCell(eyePos, sectionMin, sectionMax);
+	if (cell == translucentSortCells[section]) {
+		return 0;
+	}
+
+	translucentSortCells[section] = cell;
+
+	uint32_t first = bucketStarts[faceBucketCount + section];
+	sortFacesBackToFront(faceData.data() + first, faceCount, eyePos - startPos, lod);
+	ChunkManager::getInstance()->getMeshBuffer().update(meshRange, first, faceData.data() + first, faceCount);
+	return faceCount;
+}
+
+void Chunk::sortFacesByBucket() {
+	// counting sort, edits append faces out of order so this runs before every upload
+	std::array<uint32_t, meshBucketCount + 1> starts = {};
+	for (const FaceData& f : faceData) {
+		starts[f.getBucket(lod) + 1]++;
+	}
+
+	for (int b = 0; b < meshBucketCount; b++) {
+		starts[b + 1] += starts[b];
+	}
+
+	// one scratch buffer per thread, the loading thread sorts while staging
+	thread_local std::vector<FaceData> sortedFaces = {};
+	sortedFaces.resize(faceData.size());
+
+	std::array<uint32_t, meshBucketCount + 1> next = starts;
+	for (const FaceData& f : faceData) {
+		sortedFaces[next[f.getBucket(lod)]++] = f;
 	}
+
+	std::copy(sortedFaces.begin(), sortedFaces.end(), faceData.begin());
+	bucketStarts = starts;
 }
 
 void Chunk::changeBlockAtIndex(const IndexChangeData& changeData) {
 	indexesToChange.emplace_back(changeData);
+	edited = true;
 }
 
 void Chunk::generateChunk()
@@ -111,6 +254,21 @@ void Chunk::generateChunk()
 
 void Chunk::generateFaces()
 {
+	if (lod != 0) {
+		generateLodFaces(blocks, lod, faceData);
+		return;
+	}
+
+	// faces are checked against the blocks as they are now, edits included, so look through
+	// a snapshot since this may run on the loading thread. It keeps the neighbours alive.
+	ChunkSnapshot snapshot = ChunkManager::getInstance()->getSnapshot();
+	std::array<Chunk*, FACE_COUNT> neighbours = {};
+	for (int face = 0; face < FACE_COUNT; face++) {
+		if (faceNormals[face].z == 0) {
+			neighbours[face] = snapshot.getChunkAtIndex(chunkIndex + glm::vec2(faceNormals[face]));
+		}
+	}
+
 	for (GLuint x = 0; x < chunkSize.x; x++) {
 		for (GLuint y = 0; y < chunkSize.y; y++) {
 			for (GLuint z = 0; z < chunkSize.z; z++) {
@@ -119,72 +277,75 @@ void Chunk::generateFaces()
 				}
 
 				glm::vec3 position = {x, y, z};
-				insertFaceData(position);
+				insertFaceData(position, neighbours);
 			}
 		}
 	}
 }
 
-void Chunk::initShaderVars()
+void Chunk::computeSectionVisibility(int section)
 {
-	const GLuint vertexSize = 5 * sizeof(float);
-	float quadVertices[] = {
-		-0.5f, -0.5f, 0.0f,		0.0f, 1.0f,
-		 0.5f, -0.5f, 0.0f,		1.0f, 1.0f,
-		 0.5f,  0.5f, 0.0f,		1.0f, 0.0f,
-		-0.5f,  0.5f, 0.0f,		0.0f, 0.0f
-	};
+	std::bitset<visibilitySectionVolume> opaque;
+	int zStart = section * sectionHeight;
+
+	for (int x = 0; x < visibilitySectionSize; x++) {
+		for (int y = 0; y < visibilitySectionSize; y++) {
+			for (int z = 0; z < visibilitySectionSize; z++) {
+				size_t i = (size_t)(x + visibilitySectionSize * (y + visibilitySectionSize * z));
+				opaque[i] = isBlockOpaque(blocks[x][y][zStart + z]);
+			}
+		}
+	}
 
-	GLuint quadIndices[] = {
-		0, 1, 2,
-		2, 3, 0
-	};
+	sectionVisibility[section] = SectionVisibility::compute(opaque);
+
+	uint16_t solidLayers = 0;
+	for (int z = 0; z < visibilitySectionSize; z++) {
+		bool solid = true;
+		for (int i = 0; i < visibilitySectionSize * visibilitySectionSize && solid; i++) {
+			solid = opaque[(size_t)(z * visibilitySectionSize * visibilitySectionSize + i)];
+		}
+
+		solidLayers |= (uint16_t)((solid ? 1 : 0) << z);
+	}
+
+	sectionSolidLayers[section] = solidLayers;
+}
+
+void Chunk::restoreFromCache(const CachedChunk& cached)
+{
+	size_t runIndex = 0;
+	uint16_t runLeft = cached.blockRuns.empty() ? 0 : cached.blockRuns[0].length;
+
+	for (auto& column : blocks) {
+		for (auto& row : column) {
+			for (BlockType& b : row) {
+				while (runLeft == 0 && runIndex + 1 < cached.blockRuns.size()) {
+					runLeft = cached.blockRuns[++runIndex].length;
+				}
+
+				b = (runLeft > 0 ? cached.blockRuns[runIndex].type : AIR);
+				runLeft = (uint16_t)(runLeft > 0 ? runLeft - 1 : 0);
+			}
+		}
+	}
 
-	// Create vertex array object
-	GL_CHECK(glGenVertexArrays(1, &vao));
-	GL_CHECK(glBindVertexArray(vao));
-
-	// Create and fill vertex buffer object
-	GL_CHECK(glGenBuffers(1, &vbo));
-	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vbo));
-	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW));
-
-	// Create and fill element buffer object
-	GL_CHECK(glGenBuffers(1, &ebo));
-	GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
-	GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW));
-
-	// Position (main vbo)
-	GL_CHECK(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexSize, 0));
-	GL_CHECK(glEnableVertexAttribArray(0));
-
-	// Texcoord (main vbo)
-	GL_CHECK(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, vertexSize, (void*)(3 * sizeof(float))));
-	GL_CHECK(glEnableVertexAttribArray(1));
-	
-	GL_CHECK(glGenBuffers(1, &faceDataBuffer));
-	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, faceDataBuffer));
-	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(FaceData) * faceData.size(), faceData.data(), GL_STATIC_DRAW));
-
-	// Position (per-instance data)
-	glEnableVertexAttribArray(2);
-	glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(FaceData), (void*)0);
-	glVertexAttribDivisor(2, 1);
-
-	// Direction-Id (per-instance data)
-	glEnableVertexAttribArray(3);
-	glVertexAttribIPointer(3, 1, GL_UNSIGNED_BYTE, sizeof(FaceData), (void*)offsetof(FaceData, direction_id));
-	glVertexAttribDivisor(3, 1);
+	if (cached.lod == lod && !cached.faceData.empty()) {
+		faceData.assign(cached.faceData.begin(), cached.faceData.end());
+	}
+	else {
+		generateFaces();
+	}
 }
 
-void Chunk::insertFaceData(glm::vec3& blockIndex)
+void Chunk::insertFaceData(glm::vec3& blockIndex, const std::array<Chunk*, FACE_COUNT>& neighbours)
 {
-	auto insertData = [&](BlockFace faceDirection) {
-		if (isFaceVisible(blockIndex, faceDirection)) {
+	auto insertData = [&](BlockFace face) {
+		if (isFaceVisible(blockIndex, face, neighbours)) {
 			FaceData f;
 			f.setPosition(blockIndex);
-			f.setBlockTexId(getBlockAtIndex(blockIndex), faceDirection);
-			f.setDirection(faceDirection);
+			f.setBlockTexId(getBlockAtIndex(blockIndex), face);
+			f.setDirection(face);
 
 			faceData.emplace_back(f);
 		}
@@ -198,12 +359,25 @@ void Chunk::insertFaceData(glm::vec3& blockIndex)
 	insertData(BOTTOM);
 }
 
-bool Chunk::isFaceVisible(const glm::vec3& pos, BlockFace face)
+bool Chunk::isFaceVisible(const glm::vec3& pos, BlockFace face, const std::array<Chunk*, FACE_COUNT>& neighbours)
 {
-	glm::vec3 offset = faceNormals[face];
-	glm::vec3 queryPos = startPos + pos + offset;
+	glm::ivec3 neighbourIndex = glm::ivec3(pos) + faceNormals[face];
+	BlockType neighbourType;
+
+	if (isValidBlockIndex(neighbourIndex)) {
+		neighbourType = getBlockAtIndex(neighbourIndex);
+	}
+	else if (neighbours[face] != nullptr) {
+		glm::ivec3 wrappedIndex = glm::mod(glm::vec3(neighbourIndex), chunkSize);
+		neighbourType = neighbours[face]->getBlockAtIndex(wrappedIndex);
+	}
+	else {
+		// not loaded, or above and below the world
+		glm::vec3 queryPos = startPos + glm::vec3(neighbourIndex);
+		neighbourType = WorldGenerator::getBlockTypeAtPos(queryPos);
+	}
 
-	return (WorldGenerator::getBlockTypeAtPos(queryPos) == AIR);
+	return isBlockFaceVisible(getBlockAtIndex(pos), neighbourType);
 }
 
 bool Chunk::isValidBlockIndex(const glm::ivec3 index) const {
@@ -213,9 +387,43 @@ bool Chunk::isValidBlockIndex(const glm::ivec3 index) const {
 	return withinMin && withinMax;
 }
 
-void Chunk::reBindFaceBuffer() {
-	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, faceDataBuffer));
-	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(FaceData) * faceData.size(), faceData.data(), GL_STATIC_DRAW));
+void Chunk::uploadMesh() {
+	ChunkMeshBuffer& meshBuffer = ChunkManager::getInstance()->getMeshBuffer();
+	DeviceUploadRing* ring = ChunkManager::getInstance()->getUploadRing();
+
+	// loaded chunks were staged on the loading thread, edits are staged here
+	if (!isStaged && ring != nullptr) {
+		stageMesh(*ring);
+	}
+
+	if (isStaged) {
+		meshBuffer.copyFromStaging(meshRange, ring->getBuffer(), stagingOffset, (uint32_t)faceData.size());
+		discardStaging();
+	}
+	else {
+		// a full ring already sorted them while trying to stage
+		if (ring == nullptr) {
+			sortFacesByBucket();
+		}
+
+		meshBuffer.upload(meshRange, faceData.data(), (uint32_t)faceData.size());
+	}
+
+	uploadedFaceCount = (GLsizei)faceData.size();
+	meshDirty = false;
+
+	// bucketing keeps the last order, but faces may have been added or moved between sections
+	translucentSortCells.fill(unsortedCell);
+}
+
+void Chunk::discardStaging() {
+	// released on the render thread, once the copy recorded before it has been issued
+	if (isStaged) {
+		UploadRing* ring = ChunkManager::getInstance()->getUploadRing();
+		UploadRing::RegionId region = stagingRegion;
+		ChunkManager::getInstance()->getRenderCommands().record([ring, region]() { ring->release(region); });
+		isStaged = false;
+	}
 }
 
 void Chunk::removeBlock(const IndexChangeData& data) {
@@ -224,112 +432,83 @@ void Chunk::removeBlock(const IndexChangeData& data) {
 		return;
 	}
 
-	// for each face
-	// -> if visible, delete from faceData
-	// -> if not visible
-	//    -> if facing inside chunk, add to this chunks' faceData
-	//    -> if facing outside chunk, add to other chunks' faceData
+	replaceBlock(data.blockIndex, AIR);
+}
+
+void Chunk::addBlock(const IndexChangeData& data) {
+	// can't place blocks inside eachother
+	if (getBlockAtIndex(data.blockIndex) != AIR) {
+		return;
+	}
+
+	replaceBlock(data.blockIndex, data.blockType);
+}
 
+void Chunk::replaceBlock(const glm::ivec3& blockIndex, BlockType newType) {
+	BlockType oldType = getBlockAtIndex(blockIndex);
+
+	// each face between the block and a neighbour is re-checked from both sides,
+	// translucent blocks keep the faces behind them where opaque ones hide them
 	for (uint8_t i = 0; i < BlockFace::FACE_COUNT; i++) {
-		FaceData ref;
-		ref.setPosition(data.blockIndex);
-		ref.setDirection((BlockFace)i);
-		ref.setBlockTexId(getBlockAtIndex(data.blockIndex), (BlockFace)i);
+		glm::ivec3 neighbourIndex = blockIndex + faceNormals[i];
+		glm::ivec3 wrappedIndex = glm::mod(glm::vec3(neighbourIndex), chunkSize);
 
-		// if ref FaceData is found, then the face is 'visible' and should be deleted
-		auto itr = std::find(faceData.begin(), faceData.end(), ref);
-		if (itr != faceData.end()) {
-			faceData.erase(itr);
-		}
-		// otherwise it is not 'visible' and should be added
-		else {
-			glm::ivec3 queryIndex = data.blockIndex + faceNormals[i];
-			if (queryIndex.z < 0 || queryIndex.z >= chunkSize.z) { // outside z-axis so skip adding this face
-				continue;
-			}
-			else if (isValidBlockIndex(queryIndex)) {
-				ref.setPosition(queryIndex);
-				ref.setDirection(inverseFace[i]);
-				ref.setBlockTexId(getBlockAtIndex(queryIndex), inverseFace[i]);
+		// only the neighbours of LOD 0 chunks are edited, LOD neighbours are closed off by their border faces
+		Chunk* neighbour = nullptr;
+		BlockType neighbourType = AIR; // above and below the world
 
-				faceData.emplace_back(ref);
+		if (isValidBlockIndex(neighbourIndex)) {
+			neighbour = this;
+			neighbourType = getBlockAtIndex(neighbourIndex);
+		}
+		else if (neighbourIndex.z >= 0 && neighbourIndex.z < chunkSize.z) {
+			glm::vec3 neighbourPos = glm::vec3(neighbourIndex) + startPos;
+			if (Chunk* c = ChunkManager::getInstance()->getChunkAtIndex(posToChunkIndex(neighbourPos))) {
+				neighbour = (c->lod == 0 ? c : nullptr);
+				neighbourType = c->getBlockAtIndex(wrappedIndex);
 			}
 			else {
-				glm::vec2 index = Chunk::posToChunkIndex(queryIndex + glm::ivec3(startPos));
-				if (Chunk* c = ChunkManager::getInstance()->getChunkAtIndex(index)) {
-					glm::vec3 wrappedIndex = glm::mod(glm::vec3(queryIndex), chunkSize);
-					ref.setPosition(wrappedIndex);
-					ref.setDirection(inverseFace[i]);
-					ref.setBlockTexId(c->getBlockAtIndex(wrappedIndex), inverseFace[i]);
-
-					c->faceData.emplace_back(ref);
-					c->reBindFaceBuffer();
-				}
+				neighbourType = WorldGenerator::getBlockTypeAtPos(neighbourPos);
 			}
 		}
+
+		replaceFace(blockIndex, (BlockFace)i, oldType, isBlockFaceVisible(oldType, neighbourType), newType, isBlockFaceVisible(newType, neighbourType));
+
+		if (neighbour) {
+			BlockFace neighbourFace = inverseFace[i];
+			neighbour->replaceFace(wrappedIndex, neighbourFace, neighbourType, isBlockFaceVisible(neighbourType, oldType), neighbourType, isBlockFaceVisible(neighbourType, newType));
+		}
 	}
 
-	blocks[data.blockIndex.x][data.blockIndex.y][data.blockIndex.z] = BlockType::AIR;
-	reBindFaceBuffer();
+	blocks[blockIndex.x][blockIndex.y][blockIndex.z] = newType;
 }
 
-void Chunk::addBlock(const IndexChangeData& data) {
-	// can't place blocks inside eachother
-	if (getBlockAtIndex(data.blockIndex) != AIR) {
+void Chunk::replaceFace(const glm::ivec3& index, BlockFace face, BlockType oldType, bool wasVisible, BlockType newType, bool isVisible) {
+	if (oldType == newType && wasVisible == isVisible) {
 		return;
 	}
-	
-	// loop over all faces of new block
-	// -> if a face exists already, delete it
-	// -> otherwise, add new face
 
-	for (uint8_t i = 0; i < BlockFace::FACE_COUNT; i++) {
-		glm::ivec3 offsetIndex = data.blockIndex + faceNormals[i];
-
-		if (isValidBlockIndex(offsetIndex)) {
-			FaceData ref;
-			ref.setPosition(offsetIndex);
-			ref.setDirection(inverseFace[i]);
-			ref.setBlockTexId(getBlockAtIndex(offsetIndex), inverseFace[i]);
-
-			// face exists, delete it
-			auto itr = std::find(faceData.begin(), faceData.end(), ref);
-			if (itr != faceData.end()) {
-				faceData.erase(itr);
-			}
-			else { // add new face
-				ref.setPosition(data.blockIndex);
-				ref.setDirection((BlockFace)i);
-				ref.setBlockTexId(data.blockType, (BlockFace)i);
-				faceData.emplace_back(ref);
-			}
+	auto makeFace = [&](BlockType type) {
+		FaceData f;
+		f.setPosition(index);
+		f.setBlockTexId(type, face);
+		f.setDirection(face);
+		return f;
+	};
+
+	if (wasVisible) {
+		auto itr = std::find(faceData.begin(), faceData.end(), makeFace(oldType));
+		if (itr != faceData.end()) {
+			faceData.erase(itr);
 		}
-		else {
-			glm::vec2 index = posToChunkIndex((glm::vec3)offsetIndex + startPos);
-			if (Chunk* c = ChunkManager::getInstance()->getChunkAtIndex(index)) {
-				glm::ivec3 wrappedOffsetIndex = glm::mod((glm::vec3)offsetIndex, chunkSize);
-
-				FaceData ref;
-				ref.setPosition(wrappedOffsetIndex);
-				ref.setDirection(inverseFace[i]);
-				ref.setBlockTexId(c->getBlockAtIndex(wrappedOffsetIndex), inverseFace[i]);
-
-				// we delete the face in the adjacent chunk if it exists
-				auto itr = std::find(c->faceData.begin(), c->faceData.end(), ref);
-				if (itr != c->faceData.end()) {
-					c->faceData.erase(itr);
-					c->reBindFaceBuffer();
-				}
-				else { // but we only ever add faces to this chunk
-					ref.setPosition(data.blockIndex);
-					ref.setDirection((BlockFace)i);
-					ref.setBlockTexId(data.blockType, (BlockFace)i);
-					faceData.emplace_back(ref);
-				}
-			}
+	}
+
+	if (isVisible) {
+		FaceData f = makeFace(newType);
+		if (std::find(faceData.begin(), faceData.end(), f) == faceData.end()) {
+			faceData.emplace_back(f);
 		}
 	}
 
-	blocks[data.blockIndex.x][data.blockIndex.y][data.blockIndex.z] = data.blockType;
-	reBindFaceBuffer();
+	meshDirty = true;
 }
@@ -1,48 +1,114 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <vector>
+#include <array>
+#include <algorithm>
 
 #include "BlockAttribs.h"
 #include "glad/glad.h"
+#include "FaceAllocator.h"
+#include "FaceFormat.h"
+#include "SectionVisibility.h"
+#include "UploadRing.h"
+
+class DeviceUploadRing;
 
 constexpr glm::vec3 chunkSize = {16, 16, 128};
 constexpr glm::vec3 extentsMin = { -0.5f, -0.5f, -0.5f };
 constexpr glm::vec3 extentsMax = extentsMin + chunkSize;
 
+// chunks are split into vertical sections for culling
+constexpr int sectionHeight = 16;
+constexpr int sectionCount = (int)chunkSize.z / sectionHeight;
+
+static_assert(chunkSize.x == visibilitySectionSize && chunkSize.y == visibilitySectionSize && sectionHeight == visibilitySectionSize, "Sections must be cubes for visibility culling!");
+
+// opaque faces are bucketed by direction, then by section...
+constexpr int faceBucketCount = FACE_COUNT * sectionCount;
+
+// ...and translucent faces by section alone after them, back to front within each section
+constexpr int meshBucketCount = faceBucketCount + sectionCount;
+
+// see FaceFormat.h for the layout
 struct FaceData {
-    // position     x: 4 bits   y: 4 bits   z: 8 bits
-    // direction     : 3 bits
-    // block id      : 4 bits
-    // TOTAL         : 23 bits
-    
-    uint16_t position = 0;
-    uint8_t direction_id = 0;
+    // faces start unoccluded and fully lit
+    uint32_t words[faceWordCount] = { 0, maxFaceLight << faceLight.shift };
 
     void setPosition(const glm::ivec3& p) {
-        // p => xxxx yyyy zzzz zzzz
-        position = ((p.x & 15) << 4 | (p.y & 15)) << 8 | (p.z & 255);
+        packFaceField(words, facePosX, (uint32_t)p.x);
+        packFaceField(words, facePosY, (uint32_t)p.y);
+        packFaceField(words, facePosZ, (uint32_t)p.z);
     }
 
     void setDirection(const BlockFace d) {
-        // d => 0ddd ----
-        direction_id = ((d & 7) << 4) | (direction_id & 15);
+        packFaceField(words, faceDirection, (uint32_t)d);
     }
 
+    // also flags the faces of translucent blocks
     void setBlockTexId(const BlockType t, const BlockFace f) {
-        uint16_t b = blockTextureIds[t][f];
-        // b => ---- bbbb
-        direction_id = (direction_id & 240) | (b & 15);
+        packFaceField(words, faceTexture, blockTextureIds[t][f]);
+        packFaceField(words, faceTranslucent, isBlockTranslucent(t) ? 1u : 0u);
+    }
+
+    // @param level 0 => unoccluded, maxFaceAO => fully occluded
+    void setAO(int corner, uint8_t level) {
+        uint32_t ao = unpackFaceField(words, faceAO) & ~(3u << (corner * 2));
+        packFaceField(words, faceAO, ao | ((uint32_t)std::min(level, maxFaceAO) << (corner * 2)));
+    }
+
+    void setLight(uint8_t level) {
+        packFaceField(words, faceLight, std::min(level, maxFaceLight));
+    }
+
+    const uint16_t getTextureId() const {
+        return (uint16_t)unpackFaceField(words, faceTexture);
+    }
+
+    const BlockFace getDirection() const {
+        return (BlockFace)unpackFaceField(words, faceDirection);
+    }
+
+    const bool isTranslucent() const {
+        return unpackFaceField(words, faceTranslucent) != 0;
     }
 
-    const BlockType getBlockId() const {
-        return (BlockType)(direction_id & 15);
+    const uint8_t getAO(int corner) const {
+        return (uint8_t)((unpackFaceField(words, faceAO) >> (corner * 2)) & 3u);
     }
 
+    const uint8_t getLight() const {
+        return (uint8_t)unpackFaceField(words, faceLight);
+    }
+
+    // @returns The position in cells of 2^lod blocks
+    const glm::ivec3 getPosition() const {
+        return { (int)unpackFaceField(words, facePosX), (int)unpackFaceField(words, facePosY), (int)unpackFaceField(words, facePosZ) };
+    }
+
+    // LOD faces are positioned in cells of 2^lod blocks
+    const int getSection(uint8_t lod = 0) const {
+        return ((int)unpackFaceField(words, facePosZ) << lod) / sectionHeight;
+    }
+
+    const int getBucket(uint8_t lod = 0) const {
+        if (isTranslucent()) {
+            return faceBucketCount + getSection(lod);
+        }
+
+        return getDirection() * sectionCount + getSection(lod);
+    }
+
+    // lighting is derived from the neighbours, so faces match on what they are
     const bool operator == (const FaceData& otherFace) {
-        return position == otherFace.position && direction_id == otherFace.direction_id;
+        return words[0] == otherFace.words[0];
     }
 };
 
+static_assert(sizeof(FaceData) == faceWordCount * sizeof(uint32_t), "FaceData is pulled by the shader as one uvec2!");
+static_assert(facePosZ.mask() + 1 >= chunkSize.z, "Block positions must fit in a face!");
+
+struct CachedChunk;
+
 struct IndexChangeData {
     glm::ivec3 blockIndex = { 0, 0, 0 };
     BlockType blockType = BlockType::AIR;
@@ -51,13 +117,49 @@ struct IndexChangeData {
 class Chunk
 {
 public:
-    Chunk(glm::vec2 _chunkIndex);
+    Chunk(glm::vec2 _chunkIndex, const CachedChunk* cached = nullptr, uint8_t _lod = 0);
     ~Chunk();
 
+    // Regenerates the chunk at a new index, re-using its block storage.
+    // A cached chunk is restored as-is instead of being generated, its faces
+    // are only re-meshed if they were cached at a different LOD.
+    void load(glm::vec2 _chunkIndex, const CachedChunk* cached = nullptr, uint8_t _lod = 0);
+    void cacheTo(CachedChunk& out) const;
+    void cacheBlocksTo(CachedChunk& out) const;
+
     void init();
-    void render();
     void update();
 
+    // Gives the chunks' range of the shared face buffer back. Main thread only.
+    void releaseMesh();
+
+    // Sorts the faces and writes them to the staging ring, so uploading them is only a GPU copy.
+    // Safe on the loading thread before the chunk is published.
+    // @returns False if the ring is full, the faces are then uploaded directly
+    bool stageMesh(DeviceUploadRing& ring);
+
+    // Uploads the faces if they changed since the last upload, until then the old ones are drawn
+    // @returns True if anything was uploaded
+    bool swapMesh();
+
+    bool hasPendingChanges() const {
+        return !indexesToChange.empty();
+    }
+
+    bool hasDirtyMesh() const {
+        return meshDirty;
+    }
+
+    // @returns True if a block was changed since the chunk was generated
+    bool hasEdits() const {
+        return edited;
+    }
+
+    // @returns The number of block changes applied since the chunk was loaded
+    uint32_t getEditCount() const {
+        return editCount;
+    }
+
     void changeBlockAtIndex(const IndexChangeData& changeData);
 
     // @returns The chunk index that contains the position
@@ -81,30 +183,100 @@ public:
         return chunkIndex;
     }
 
+    // @returns The level of detail the faces are meshed at, 0 is full detail
+    const uint8_t getLod() const {
+        return lod;
+    }
+
     const size_t getFaceCount() const {
         return faceData.size();
     }
 
+    const FaceRange& getMeshRange() const {
+        return meshRange;
+    }
+
+    const GLsizei getUploadedFaceCount() const {
+        return uploadedFaceCount;
+    }
+
+    // @returns Where each face buckets' faces start in the uploaded mesh, the last entry is the face count
+    const std::array<uint32_t, meshBucketCount + 1>& getBucketStarts() const {
+        return bucketStarts;
+    }
+
+    // @returns The number of uploaded translucent faces in the section
+    const uint32_t getTranslucentFaceCount(int section) const {
+        return bucketStarts[faceBucketCount + section + 1] - bucketStarts[faceBucketCount + section];
+    }
+
+    // @returns Which faces of the section see each other through non-opaque blocks
+    const SectionVisibility& getSectionVisibility(int section) const {
+        return sectionVisibility[section];
+    }
+
+    // @returns A bit per block layer of the section, set if every block in the layer is opaque
+    const uint16_t getSolidLayers(int section) const {
+        return sectionSolidLayers[section];
+    }
+
+    // @returns The number of uploaded faces in the section, across all directions and both passes
+    const uint32_t getSectionFaceCount(int section) const;
+
+    // Sorts the sections' translucent faces back to front from 'eyePos' and re-uploads them,
+    // if the eye moved across the section since they were last sorted. Main thread only.
+    // @returns The number of faces sorted
+    uint32_t sortTranslucentFaces(int section, const glm::vec3& eyePos);
+
+    // @returns The number of bytes init() will upload to the GPU
+    const size_t getUploadSize() const {
+        return sizeof(FaceData) * faceData.size();
+    }
+
 private:
     void generateChunk();
     void generateFaces();
-    void initShaderVars();
+    void computeSectionVisibility(int section);
+    void restoreFromCache(const CachedChunk& cached);
 
-    void insertFaceData(glm::vec3& blockIndex);
-    bool isFaceVisible(const glm::vec3& pos, BlockFace face);
+    // 'neighbours' are the loaded chunks past each side, or nullptr
+    void insertFaceData(glm::vec3& blockIndex, const std::array<Chunk*, FACE_COUNT>& neighbours);
+    bool isFaceVisible(const glm::vec3& pos, BlockFace face, const std::array<Chunk*, FACE_COUNT>& neighbours);
     bool isValidBlockIndex(const glm::ivec3 index) const;
 
-    void reBindFaceBuffer();
+    void uploadMesh();
+    void sortFacesByBucket();
+    void discardStaging();
 
     void removeBlock(const IndexChangeData& data);
     void addBlock(const IndexChangeData& data);
+    void replaceBlock(const glm::ivec3& blockIndex, BlockType newType);
+
+    // Swaps the face at 'index' for one of 'newType', either can be invisible (absent)
+    void replaceFace(const glm::ivec3& index, BlockFace face, BlockType oldType, bool wasVisible, BlockType newType, bool isVisible);
 
 private:
     glm::vec3 startPos = { 0, 0, 0 };
     glm::vec2 chunkIndex = { 0, 0 };
+    uint8_t lod = 0;
+
+    FaceRange meshRange = {};
+    std::array<uint32_t, meshBucketCount + 1> bucketStarts = {};
+    std::array<SectionVisibility, sectionCount> sectionVisibility = {};
+    std::array<uint16_t, sectionCount> sectionSolidLayers = {};
+    GLsizei uploadedFaceCount = 0;
+    bool meshDirty = false;
+    bool edited = false;
+    uint32_t editCount = 0;
+
+    // where the eye was when each sections' translucent faces were sorted, see getTranslucentSortCell
+    std::array<glm::ivec3, sectionCount> translucentSortCells = {};
+
+    // faces written to the staging ring but not yet copied out of it
+    bool isStaged = false;
+    UploadRing::RegionId stagingRegion = 0;
+    size_t stagingOffset = 0;
 
-    GLuint vao, vbo, ebo;
-    GLuint faceDataBuffer;
     std::vector<FaceData> faceData = {};
     std::vector<std::vector<std::vector<BlockType>>> blocks;
 
@@ -0,0 +1,74 @@
+#include "ChunkCache.h"
+
+void ChunkCache::setBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	budgetBytes = bytes;
+	while (stats.usedBytes > budgetBytes && !lru.empty()) {
+		eraseEntry(entries.find(lru.back()));
+		stats.evictions++;
+	}
+}
+
+void ChunkCache::store(const Chunk& chunk) {
+	if (budgetBytes == 0) {
+		return;
+	}
+
+	// compress outside the lock, so loading threads aren't held up
+	CachedChunk cached;
+	chunk.cacheTo(cached);
+
+	size_t memoryUsage = cached.getMemoryUsage();
+	glm::vec2 index = chunk.getChunkIndex();
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	auto existing = entries.find(index);
+	if (existing != entries.end()) {
+		eraseEntry(existing);
+	}
+
+	lru.push_front(index);
+	entries[index] = { std::move(cached), lru.begin() };
+	stats.usedBytes += memoryUsage;
+
+	while (stats.usedBytes > budgetBytes && !lru.empty()) {
+		eraseEntry(entries.find(lru.back()));
+		stats.evictions++;
+	}
+}
+
+bool ChunkCache::take(const glm::vec2& index, CachedChunk& out) {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	auto itr = entries.find(index);
+	if (itr == entries.end()) {
+		return false;
+	}
+
+	size_t memoryUsage = itr->second.chunk.getMemoryUsage();
+	out = std::move(itr->second.chunk);
+
+	lru.erase(itr->second.lruPos);
+	entries.erase(itr);
+	stats.usedBytes -= memoryUsage;
+	stats.hits++;
+
+	return true;
+}
+
+ChunkCacheStats ChunkCache::getStats() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	ChunkCacheStats s = stats;
+	s.entries = entries.size();
+	s.budgetBytes = budgetBytes;
+	return s;
+}
+
+void ChunkCache::eraseEntry(std::map<glm::vec2, Entry, Vec2Comparator>::iterator itr) {
+	stats.usedBytes -= itr->second.chunk.getMemoryUsage();
+	lru.erase(itr->second.lruPos);
+	entries.erase(itr);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "Chunk.h"
+#include "ChunkStorage.h"
+
+struct BlockRun {
+	uint16_t length = 0;
+	BlockType type = AIR;
+};
+
+// An unloaded chunk, with its blocks run-length encoded (in x, y, z order)
+// and its faces kept as they were, so it can come back without re-generating.
+struct CachedChunk {
+	std::vector<BlockRun> blockRuns = {};
+	std::vector<FaceData> faceData = {};
+	uint8_t lod = 0; // the faces' level of detail, a copy without faces is always re-meshed
+	bool edited = false;
+
+	size_t getMemoryUsage() const {
+		return sizeof(CachedChunk) + sizeof(BlockRun) * blockRuns.capacity() + sizeof(FaceData) * faceData.capacity();
+	}
+};
+
+struct ChunkCacheStats {
+	size_t entries = 0;
+	size_t usedBytes = 0;
+	size_t budgetBytes = 0;
+	size_t hits = 0;
+	size_t evictions = 0;
+};
+
+// Memory-budgeted LRU cache of recently unloaded chunks, so walking back
+// into an area keeps its edits and skips the world generator.
+class ChunkCache
+{
+public:
+	void setBudget(size_t bytes);
+
+	// Compresses and caches the chunk, evicting the least recently used ones if over budget
+	void store(const Chunk& chunk);
+
+	// Moves the cached chunk at 'index' into 'out'
+	// @returns False if the chunk isn't cached
+	bool take(const glm::vec2& index, CachedChunk& out);
+
+	ChunkCacheStats getStats();
+
+private:
+	struct Entry {
+		CachedChunk chunk;
+		std::list<glm::vec2>::iterator lruPos;
+	};
+
+	void eraseEntry(std::map<glm::vec2, Entry, Vec2Comparator>::iterator itr);
+
+private:
+	std::mutex cacheMutex;
+	std::map<glm::vec2, Entry, Vec2Comparator> entries = {};
+	std::list<glm::vec2> lru = {}; // most recently stored at the front
+
+	size_t budgetBytes = 0;
+	ChunkCacheStats stats;
+};
@@ -0,0 +1,103 @@
+#include "ChunkDrawOrder.h"
+#include "Chunk.h"
+
+#include <algorithm>
+#include <limits>
+
+void ChunkDrawOrder::sort(std::vector<Chunk*>& chunks, const glm::vec3& eyePos) {
+	drawable.clear();
+	drawable.insert(chunks.begin(), chunks.end());
+
+	// keeps last frames' order for the chunks that are still drawn...
+	size_t kept = 0;
+	for (const Entry& e : order) {
+		if (drawable.erase(e.chunk) != 0) {
+			order[kept++] = e;
+		}
+	}
+	order.resize(kept);
+
+	// ...and adds the new ones behind them
+	for (Chunk* c : chunks) {
+		if (drawable.count(c) != 0) {
+			order.push_back({ c, 0.f });
+		}
+	}
+
+	for (Entry& e : order) {
+		glm::vec3 center = e.chunk->getStartPos() + (extentsMin + extentsMax) * 0.5f;
+		glm::vec2 toEye = glm::vec2(eyePos - center); // chunks are whole columns
+		e.distance = glm::dot(toEye, toEye);
+	}
+
+	lastMoves = 0;
+	for (size_t i = 1; i < order.size(); i++) {
+		Entry e = order[i];
+		size_t j = i;
+		while (j > 0 && order[j - 1].distance > e.distance) {
+			order[j] = order[j - 1];
+			j--;
+		}
+
+		order[j] = e;
+		lastMoves += i - j;
+	}
+
+	for (size_t i = 0; i < order.size(); i++) {
+		chunks[i] = order[i].chunk;
+	}
+}
+
+void OverdrawEstimator::begin(const glm::mat4& _viewProj, const glm::vec3& _eyePos) {
+	viewProj = _viewProj;
+	eyePos = _eyePos;
+	depths.fill(std::numeric_limits<float>::max());
+	shadedTiles = 0;
+}
+
+void OverdrawEstimator::addBox(const glm::vec3& min, const glm::vec3& max) {
+	glm::vec2 ndcMin = glm::vec2(1.f), ndcMax = glm::vec2(-1.f);
+	bool crossesNear = false;
+
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+		glm::vec4 clip = viewProj * glm::vec4(corner, 1.f);
+
+		// a box behind the eye on one side can cover any part of the screen
+		if (clip.w <= 0.01f) {
+			crossesNear = true;
+			break;
+		}
+
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+
+	if (crossesNear) {
+		ndcMin = glm::vec2(-1.f);
+		ndcMax = glm::vec2(1.f);
+	}
+
+	int x0 = std::max((int)((ndcMin.x * 0.5f + 0.5f) * gridWidth), 0);
+	int x1 = std::min((int)((ndcMax.x * 0.5f + 0.5f) * gridWidth), gridWidth - 1);
+	int y0 = std::max((int)((ndcMin.y * 0.5f + 0.5f) * gridHeight), 0);
+	int y1 = std::min((int)((ndcMax.y * 0.5f + 0.5f) * gridHeight), gridHeight - 1);
+
+	glm::vec3 toBox = glm::clamp(eyePos, min, max) - eyePos;
+	float depth = glm::dot(toBox, toBox);
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			float& tile = depths[(size_t)(y * gridWidth + x)];
+			if (depth < tile) {
+				tile = depth;
+				shadedTiles++;
+			}
+		}
+	}
+}
+
+size_t OverdrawEstimator::getCoveredTiles() const {
+	return (size_t)std::count_if(depths.begin(), depths.end(), [](float d) { return d != std::numeric_limits<float>::max(); });
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Chunk;
+
+// Orders the chunks to draw nearest first, so near terrain fills the depth buffer
+// before the terrain it hides is drawn, and the hidden fragments are rejected early.
+// Last frames' order is re-sorted with an insertion sort, which is close to linear
+// while the camera moves smoothly and only a few chunks swap places.
+class ChunkDrawOrder
+{
+public:
+	// Reorders 'chunks' nearest first to 'eyePos', chunks not drawn last frame start at the back
+	void sort(std::vector<Chunk*>& chunks, const glm::vec3& eyePos);
+
+	// @returns How many places chunks moved in the last sort, 0 if the order didn't change
+	size_t getLastMoves() const { return lastMoves; }
+
+private:
+	struct Entry {
+		Chunk* chunk = nullptr;
+		float distance = 0.f; // squared, from the eye to the chunks' center
+	};
+
+	std::vector<Entry> order = {}; // only dereferenced for chunks that are passed to sort() again
+	std::unordered_set<Chunk*> drawable = {};
+	size_t lastMoves = 0;
+};
+
+// A rough count of the fragments the opaque draws shade, from the screen rects of their sections in draw order.
+// Sections count as solid boxes at their nearest depth on a coarse grid of tiles, so only the
+// ratio to the covered tiles means anything, it goes down as the draw order improves.
+class OverdrawEstimator
+{
+public:
+	void begin(const glm::mat4& viewProj, const glm::vec3& eyePos);
+	void addBox(const glm::vec3& min, const glm::vec3& max);
+
+	size_t getShadedTiles() const { return shadedTiles; }	// tiles that passed the depth test, counted once per box
+	size_t getCoveredTiles() const;							// tiles any box covered
+
+private:
+	static constexpr int gridWidth = 64, gridHeight = 36;
+
+	std::array<float, gridWidth * gridHeight> depths = {};
+	glm::mat4 viewProj = glm::mat4(1.f);
+	glm::vec3 eyePos = { 0, 0, 0 };
+	size_t shadedTiles = 0;
+};
@@ -1,23 +1,96 @@
 #include "ChunkManager.h"
 #include "Chunk.h"
+#include "AssetManager.h"
+#include "LodMesher.h"
+#include "DeviceUploadRing.h"
+#include <chrono>
 
 ChunkManager* ChunkManager::instance = nullptr;
 
-ChunkManager::ChunkManager() {
+// @returns True once 'budgetMs' has passed since 't_start', a negative budget never runs out
+static bool isOverBudget(const std::chrono::high_resolution_clock::time_point& t_start, float budgetMs) {
+	std::chrono::duration<float, std::milli> t_elapsed = std::chrono::high_resolution_clock::now() - t_start;
+	return budgetMs >= 0.f && t_elapsed.count() >= budgetMs;
+}
+
+ChunkSnapshot::ChunkSnapshot(const std::atomic<const ChunkStorage*>& publishedChunks) {
+	chunks = publishedChunks.load(std::memory_order_seq_cst);
+}
+
+Chunk* ChunkSnapshot::getChunkAtIndex(const glm::vec2& index) const {
+	return chunks->get(index);
+}
+
+const BlockType ChunkSnapshot::getBlockAtPos(const glm::ivec3& pos) const {
+	glm::vec2 chunkIndex = Chunk::posToChunkIndex(pos);
+
+	if (Chunk* c = chunks->get(chunkIndex)) {
+		return c->getBlockAtIndex(pos - glm::ivec3(c->getStartPos()));
+	}
+
+	return AIR;
+}
+
+size_t ChunkSnapshot::chunkCount() const {
+	return chunks->size();
+}
+
+ChunkManager::ChunkManager() : meshBuffer(renderCommands), farTerrain(meshBuffer) {
+	worldChunks = new MapChunkStorage();
+	publishedChunks = worldChunks->clone();
+
 	loadingThread = std::thread(&ChunkManager::loadingThreadFunc, this);
 }
 
 ChunkManager::~ChunkManager() {
 	shouldLoadChunks = false;
 	loadingThread.join();
+
+	Chunk* pending = nullptr;
+	while (loadedChunks.pop(&pending)) {
+		delete pending;
+	}
+
+	// no readers are left, so everything retired can go now
+	EpochReclaimer::collect();
+
+	worldChunks->forEach([](const glm::vec2&, Chunk* c) {
+		delete c;
+	});
+
+	for (Chunk* c : removedChunks) {
+		delete c;
+	}
+
+	for (auto& p : prefetchedChunks) {
+		delete p.second;
+	}
+
+	delete publishedChunks.load();
+	delete worldChunks;
+
+	// after the chunks, which give their staged regions back to it
+	delete uploadRing.load();
 }
 
-void ChunkManager::initChunks(uint8_t renderDistance) {
+void ChunkManager::initChunks(uint8_t renderDistance, bool useRingStorage) {
 	if (renderDistance == 0) {
 		printf("Render distance 0 not allowed!\n");
 		return;
 	}
 
+	windowRadius = renderDistance;
+	farTerrain.setRange(windowRadius, farTerrainDistance);
+
+	// enough to recycle both edges of the window on a diagonal move
+	chunkPool.setCapacity((size_t)(4 * (2 * renderDistance - 1)));
+
+	if (useRingStorage) {
+		delete worldChunks;
+		worldChunks = new RingChunkStorage(renderDistance);
+		chunksDirty = true;
+	}
+
 	auto topEdge = [&](int dist, int count, bool flip) {
 		for (int i = 0; i < count; i++) {
 			int multi = (flip ? -1 : 1);
@@ -47,133 +120,853 @@ void ChunkManager::initChunks(uint8_t renderDistance) {
 	}
 }
 
-void ChunkManager::updateChunks() {
-	std::lock_guard<std::mutex> lock(chunkMutex);
+void ChunkManager::updateChunks(float budgetMs) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+	bool updatedAny = false;
+
+	// chunks that don't fit keep their changes until next frame
+	worldChunks->forEach([&](const glm::vec2&, Chunk* c) {
+		if (!c->hasPendingChanges() || (updatedAny && isOverBudget(t_start, budgetMs))) {
+			return;
+		}
+
+		c->update();
+		updatedAny = true;
+	});
+}
 
-	std::vector<glm::vec2> nullIndexes = {};
+void ChunkManager::swapMeshes(float budgetMs) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+	bool swappedAny = false;
+
+	// chunks that don't fit keep drawing their old mesh until next frame
+	worldChunks->forEach([&](const glm::vec2&, Chunk* c) {
+		if (!c->hasDirtyMesh() || (swappedAny && isOverBudget(t_start, budgetMs))) {
+			return;
+		}
+
+		swappedAny |= c->swapMesh();
+	});
+
+	flushStaging();
+}
 
-	for (auto& c : worldChunks) {
-		if (c.second == nullptr) {
-			nullIndexes.emplace_back(c.first);
+void ChunkManager::collectGarbage(float budgetMs) {
+	// deleters run here on the main thread, which owns the chunks' face buffer ranges
+	EpochReclaimer::collect(budgetMs);
+}
+
+void ChunkManager::updateFarTerrain(float budgetMs) {
+	farTerrain.update(budgetMs);
+}
+
+void ChunkManager::renderChunks(const glm::mat4& viewProj, const glm::vec3& eyePos, RenderPacket& packet) {
+	if (!renderStateReady) {
+		initRenderState();
+	}
+
+	drawStats = {};
+	Frustum frustum = Frustum::fromViewProjection(viewProj);
+
+	// whole chunks first...
+	drawableChunks.clear();
+	worldChunks->forEach([&](const glm::vec2&, Chunk* c) {
+		if (c->getUploadedFaceCount() == 0) {
+			return;
+		}
+
+		drawableChunks.push_back(c);
+		drawStats.lodChunks += (c->getLod() != 0);
+	});
+
+	// the order is kept by everything below, so the draws come out nearest first
+	if (frontToBack) {
+		chunkOrder.sort(drawableChunks, eyePos);
+		drawStats.reorderedChunks = chunkOrder.getLastMoves();
+	}
+
+	chunkBoxes.clear();
+	for (Chunk* c : drawableChunks) {
+		chunkBoxes.add(c->getStartPos() + extentsMin, c->getStartPos() + extentsMax);
+	}
+
+	size_t visibleChunks = chunkBoxes.cull(frustum, chunkVisible);
+
+	if (occlusionCulling) {
+		cullHiddenChunks(viewProj, eyePos);
+	}
+
+	// ...then the sections of the chunks that passed, skipping empty ones
+	sectionBoxes.clear();
+	drawableSections.clear();
+	for (size_t i = 0; i < drawableChunks.size(); i++) {
+		if (!chunkVisible[i]) {
 			continue;
 		}
 
-		c.second->update();
+		Chunk* c = drawableChunks[i];
+		for (int s = 0; s < sectionCount; s++) {
+			if (c->getSectionFaceCount(s) == 0) {
+				continue;
+			}
+
+			glm::vec3 sectionMin = c->getStartPos() + extentsMin + glm::vec3(0, 0, s * sectionHeight);
+			sectionBoxes.add(sectionMin, sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight));
+			drawableSections.emplace_back(c, s);
+		}
+	}
+
+	size_t visibleSections = sectionBoxes.cull(frustum, sectionVisible);
+
+	if (caveCulling) {
+		cullOccludedSections(frustum, eyePos);
+	}
+
+	if (occlusionCulling) {
+		cullHiddenSections();
+	}
+
+	buildChunkDraws(eyePos);
+	buildTranslucentDraws(eyePos);
+
+	// behind everything in the window, so after it
+	size_t windowDraws = chunkDraws.size();
+	farTerrain.buildDraws(frustum, eyePos, chunkDraws);
+	drawStats.farTiles = chunkDraws.size() - windowDraws;
+
+	if (overdrawEstimate) {
+		estimateOverdraw(viewProj, eyePos);
 	}
 
-	for (auto& index : nullIndexes) {
-		worldChunks.erase(index);
+	drawStats.chunks = drawableChunks.size();
+	drawStats.culledChunks = drawableChunks.size() - visibleChunks;
+	drawStats.sections = drawableSections.size();
+	drawStats.culledSections = drawableSections.size() - visibleSections;
+
+	// uploads are recorded ahead of the draws that use them
+	packet.glCommands.append(renderCommands);
+
+	// per-frame state is bound once, chunks only differ in their draw command
+	packet.meshBuffer = &meshBuffer;
+	packet.chunkProgram = chunkProgram;
+	packet.blockTextures = blockTextures;
+	buildDrawCommands(chunkDraws, packet.chunkCommands, packet.chunkDrawData);
+	buildDrawCommands(sortedTranslucentDraws, packet.translucentCommands, packet.translucentDrawData);
+
+	if (!packet.chunkCommands.empty()) {
+		drawStats.drawCalls++;
+		drawStats.drawCommands += packet.chunkCommands.size();
 	}
 
-	nullIndexes.clear();
+	if (!packet.translucentCommands.empty()) {
+		drawStats.drawCalls++;
+		drawStats.drawCommands += packet.translucentCommands.size();
+	}
 }
 
-void ChunkManager::renderChunks() {
-	std::lock_guard<std::mutex> lock(chunkMutex);
+void ChunkManager::buildChunkDraws(const glm::vec3& eyePos) {
+	chunkDraws.clear();
+
+	// merges the bucket into the last draw if it directly follows it in the face buffer
+	auto addBucket = [&](Chunk* c, int bucket) {
+		const auto& starts = c->getBucketStarts();
+		uint32_t offset = c->getMeshRange().offset + starts[bucket];
+		uint32_t faceCount = starts[bucket + 1] - starts[bucket];
+
+		ChunkDraw* prev = chunkDraws.empty() ? nullptr : &chunkDraws.back();
+		if (prev && prev->chunkIndex == c->getChunkIndex() && prev->range.offset + prev->range.size == offset) {
+			prev->range.size += faceCount;
+			prev->faceCount = prev->range.size;
+			return;
+		}
+
+		chunkDraws.push_back({ { offset, faceCount }, faceCount, c->getChunkIndex(), c->getLod() });
+	};
 
-	std::vector<glm::vec2> nullIndexes = {};
+	// the sections of each chunk are next to each other in drawableSections
+	for (size_t first = 0; first < drawableSections.size();) {
+		Chunk* c = drawableSections[first].first;
 
-	for (auto& c : worldChunks) {
-		if (c.second == nullptr) {
-			nullIndexes.emplace_back(c.first);
+		size_t last = first;
+		while (last < drawableSections.size() && drawableSections[last].first == c) {
+			last++;
+		}
+
+		// buckets are direction major, so one directions' visible sections end up in one draw
+		for (int d = 0; d < FACE_COUNT; d++) {
+			for (size_t i = first; i < last; i++) {
+				int s = drawableSections[i].second;
+				int bucket = d * sectionCount + s;
+				uint32_t faceCount = c->getBucketStarts()[bucket + 1] - c->getBucketStarts()[bucket];
+
+				if (!sectionVisible[i] || faceCount == 0) {
+					continue;
+				}
+
+				// every face in the bucket points away from the camera
+				glm::vec3 sectionMin = c->getStartPos() + extentsMin + glm::vec3(0, 0, s * sectionHeight);
+				glm::vec3 sectionMax = sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight);
+				if (!canFacesBeVisible(glm::vec3(faceNormals[d]), sectionMin, sectionMax, eyePos)) {
+					drawStats.backFacingFaces += faceCount;
+					continue;
+				}
+
+				addBucket(c, bucket);
+			}
+		}
+
+		first = last;
+	}
+}
+
+void ChunkManager::cullHiddenChunks(const glm::mat4& viewProj, const glm::vec3& eyePos) {
+	// only the nearest chunks cover enough of the screen to be worth rasterizing
+	constexpr float occluderRange = 3.f * chunkSize.x;
+	constexpr size_t maxOccluders = 64;
+
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	occlusionBuffer.begin(viewProj);
+	for (size_t i = 0; i < drawableChunks.size() && drawStats.occluders < maxOccluders; i++) {
+		Chunk* c = drawableChunks[i];
+		glm::vec2 toEye = glm::vec2(eyePos - (c->getStartPos() + (extentsMin + extentsMax) * 0.5f));
+
+		// LOD meshes don't match the blocks exactly
+		if (!chunkVisible[i] || c->getLod() != 0 || glm::dot(toEye, toEye) > occluderRange * occluderRange) {
 			continue;
 		}
 
-		c.second->render();
+		// each run of fully opaque block layers is one box, even across sections
+		auto isLayerSolid = [&](int z) {
+			return (c->getSolidLayers(z / sectionHeight) >> (z % sectionHeight)) & 1;
+		};
+
+		for (int z = 0; z < (int)chunkSize.z; z++) {
+			if (!isLayerSolid(z)) {
+				continue;
+			}
+
+			int top = z + 1;
+			while (top < (int)chunkSize.z && isLayerSolid(top)) {
+				top++;
+			}
+
+			glm::vec3 min = c->getStartPos() + extentsMin + glm::vec3(0, 0, z);
+			glm::vec3 max = c->getStartPos() + extentsMin + glm::vec3(chunkSize.x, chunkSize.y, top);
+			drawStats.occluders += occlusionBuffer.addOccluder(min, max, eyePos);
+			z = top;
+		}
 	}
 
-	for (auto& index : nullIndexes) {
-		worldChunks.erase(index);
+	for (size_t i = 0; i < drawableChunks.size(); i++) {
+		Chunk* c = drawableChunks[i];
+		if (chunkVisible[i] && !occlusionBuffer.isBoxVisible(c->getStartPos() + extentsMin, c->getStartPos() + extentsMax)) {
+			chunkVisible[i] = 0;
+			drawStats.hiddenChunks++;
+		}
 	}
 
-	nullIndexes.clear();
+	std::chrono::duration<float, std::milli> t_cull = std::chrono::high_resolution_clock::now() - t_start;
+	drawStats.occlusionMs += t_cull.count();
+}
+
+void ChunkManager::cullHiddenSections() {
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	for (size_t i = 0; i < drawableSections.size(); i++) {
+		if (!sectionVisible[i]) {
+			continue;
+		}
+
+		auto [c, s] = drawableSections[i];
+		glm::vec3 sectionMin = c->getStartPos() + extentsMin + glm::vec3(0, 0, s * sectionHeight);
+		if (!occlusionBuffer.isBoxVisible(sectionMin, sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight))) {
+			sectionVisible[i] = 0;
+			drawStats.hiddenSections++;
+		}
+	}
+
+	std::chrono::duration<float, std::milli> t_cull = std::chrono::high_resolution_clock::now() - t_start;
+	drawStats.occlusionMs += t_cull.count();
+}
+
+void ChunkManager::estimateOverdraw(const glm::mat4& viewProj, const glm::vec3& eyePos) {
+	overdraw.begin(viewProj, eyePos);
+
+	// in the order the opaque draws were built, translucent faces don't write depth
+	for (size_t i = 0; i < drawableSections.size(); i++) {
+		auto [c, s] = drawableSections[i];
+		if (!sectionVisible[i] || c->getSectionFaceCount(s) == c->getTranslucentFaceCount(s)) {
+			continue;
+		}
+
+		glm::vec3 sectionMin = c->getStartPos() + extentsMin + glm::vec3(0, 0, s * sectionHeight);
+		overdraw.addBox(sectionMin, sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight));
+	}
+
+	drawStats.shadedTiles = overdraw.getShadedTiles();
+	drawStats.coveredTiles = overdraw.getCoveredTiles();
+}
+
+void ChunkManager::buildTranslucentDraws(const glm::vec3& eyePos) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	translucentDraws.clear();
+	for (size_t i = 0; i < drawableSections.size(); i++) {
+		auto [c, s] = drawableSections[i];
+		uint32_t faceCount = c->getTranslucentFaceCount(s);
+		if (!sectionVisible[i] || faceCount == 0) {
+			continue;
+		}
+
+		// faces only re-sort when the eye moves across the section, they're drawn in buffer order
+		uint32_t sortedFaces = c->sortTranslucentFaces(s, eyePos);
+		drawStats.sortedSections += (sortedFaces > 0);
+		drawStats.sortedFaces += sortedFaces;
+
+		// sections are ordered every frame, one draw command each
+		uint32_t offset = c->getMeshRange().offset + c->getBucketStarts()[faceBucketCount + s];
+		glm::vec3 sectionCenter = c->getStartPos() + extentsMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight) * 0.5f + glm::vec3(0, 0, s * sectionHeight);
+		glm::vec3 toEye = eyePos - sectionCenter;
+		translucentDraws.push_back({ { { offset, faceCount }, faceCount, c->getChunkIndex(), c->getLod() }, glm::dot(toEye, toEye) });
+	}
+
+	sortDrawsBackToFront(translucentDraws);
+
+	sortedTranslucentDraws.clear();
+	for (const TranslucentDraw& d : translucentDraws) {
+		sortedTranslucentDraws.push_back(d.draw);
+	}
+
+	std::chrono::duration<float, std::milli> t_sort = std::chrono::high_resolution_clock::now() - t_start;
+	drawStats.translucentSections = translucentDraws.size();
+	drawStats.translucentSortMs = t_sort.count();
+}
+
+void ChunkManager::cullOccludedSections(const Frustum& frustum, const glm::vec3& eyePos) {
+	// one cell per section in the render window
+	int windowSize = 2 * windowRadius - 1;
+	glm::vec2 originChunk = centerChunk - glm::vec2(windowRadius - 1);
+	sectionGraph.reset({ windowSize, windowSize, sectionCount });
+
+	worldChunks->forEach([&](const glm::vec2& index, Chunk* c) {
+		glm::ivec2 cell = index - originChunk;
+		if (!sectionGraph.isInGrid({ cell, 0 })) {
+			return;
+		}
+
+		for (int s = 0; s < sectionCount; s++) {
+			sectionGraph.setSection({ cell, s }, c->getSectionVisibility(s));
+		}
+	});
+
+	auto cellMin = [&](const glm::ivec3& cell) {
+		return glm::vec3(originChunk, 0) * chunkSize + extentsMin + glm::vec3(cell) * (float)sectionHeight;
+	};
+
+	// blocks are centered on their index, so sections start half a block early
+	glm::ivec3 startCell = glm::floor((eyePos - cellMin({ 0, 0, 0 })) / (float)sectionHeight);
+
+	// above / below the world or outside the window, nothing to search from
+	if (!sectionGraph.isInGrid(startCell)) {
+		return;
+	}
+
+	sectionGraph.findVisible(startCell, [&](const glm::ivec3& cell) {
+		glm::vec3 min = cellMin(cell);
+		return frustum.isBoxVisible(min, min + glm::vec3(sectionHeight));
+	}, reachableSections);
+
+	for (size_t i = 0; i < drawableSections.size(); i++) {
+		auto [c, s] = drawableSections[i];
+		glm::ivec3 cell = { glm::ivec2(c->getChunkIndex() - originChunk), s };
+
+		if (sectionVisible[i] && sectionGraph.isInGrid(cell) && !reachableSections[sectionGraph.cellToIndex(cell)]) {
+			sectionVisible[i] = 0;
+			drawStats.occludedSections++;
+		}
+	}
+}
+
+void ChunkManager::setCaveCulling(bool enabled) {
+	caveCulling = enabled;
+}
+
+void ChunkManager::setFrontToBack(bool enabled) {
+	frontToBack = enabled;
+}
+
+void ChunkManager::setOverdrawEstimate(bool enabled) {
+	overdrawEstimate = enabled;
+	drawStats.shadedTiles = 0;
+	drawStats.coveredTiles = 0;
+}
+
+void ChunkManager::setOcclusionCulling(bool enabled) {
+	occlusionCulling = enabled;
+}
+
+void ChunkManager::initRenderState() {
+	chunkProgram = AssetManager::getAssetHandle("generic");
+	blockTextures = AssetManager::getAssetHandle("texture-atlas");
+	renderStateReady = true;
 }
 
 size_t ChunkManager::chunkCount() {
-	return worldChunks.size();
+	return worldChunks->size();
 }
 
 const size_t ChunkManager::getFaceCount() const {
-	std::lock_guard<std::mutex> lock(getInstance()->chunkMutex);
-
 	size_t count = 0;
-	for (auto& c : worldChunks) {
-		count += c.second->getFaceCount();
-	}
+	worldChunks->forEach([&](const glm::vec2&, Chunk* c) {
+		count += c->getFaceCount();
+	});
 	return count;
 }
 
 Chunk * ChunkManager::getChunkAtIndex(const glm::vec2 & index) {
-	if (worldChunks.find(index) != worldChunks.end()) {
-		return worldChunks[index];
-	}
-
-	return nullptr;
+	return worldChunks->get(index);
 }
 
-const std::pair<const glm::vec2, Chunk*>& ChunkManager::at(size_t index) const {
-	auto itr = worldChunks.begin();
-	std::advance(itr, index);
-	return *itr;
+ChunkSnapshot ChunkManager::getSnapshot() const {
+	return ChunkSnapshot(publishedChunks);
 }
 
 const BlockType ChunkManager::getBlockAtPos(const glm::ivec3& pos) const {
-	glm::vec2 chunkIndex = Chunk::posToChunkIndex(pos);
-	Chunk* c = getInstance()->getChunkAtIndex(chunkIndex);
+	return getSnapshot().getBlockAtPos(pos);
+}
 
-	if (c) {
-		return c->getBlockAtIndex(pos - glm::ivec3(c->getStartPos()));
+void ChunkManager::removeChunk(glm::vec2& chunkIndex) {
+	// snapshots may still reference the chunk, so it is only retired on the next publish
+	if (Chunk* c = worldChunks->erase(chunkIndex)) {
+		chunkCache.store(*c);
+		farTerrain.summarizeChunk(*c);
+		removedChunks.emplace_back(c);
+		chunksDirty = true;
 	}
+}
+
+void ChunkManager::addChunk(const glm::vec2& chunkIndex) {
+	std::lock_guard<std::mutex> lock(chunkMutex);
 	
-	return AIR;
+	indexToLoad.push(chunkIndex);
 }
 
-void ChunkManager::removeChunk(glm::vec2& chunkIndex) {
+RenderWindowDiff ChunkManager::diffRenderWindow(const glm::vec2& newCenter) const {
+	RenderWindowDiff diff;
+
+	// leaving => loaded chunks outside the new window
+	worldChunks->forEach([&](const glm::vec2& index, Chunk*) {
+		glm::vec2 offset = glm::abs(index - newCenter);
+		if (offset.x >= (float)windowRadius || offset.y >= (float)windowRadius) {
+			diff.leaving.emplace_back(index);
+		}
+	});
+
+	// entering => squares of the new window that the old window didn't cover
+	for (int x = 1 - windowRadius; x < windowRadius; x++) {
+		for (int y = 1 - windowRadius; y < windowRadius; y++) {
+			glm::vec2 index = newCenter + glm::vec2(x, y);
+			if (!isInRenderWindow(index)) {
+				diff.entering.emplace_back(index);
+			}
+		}
+	}
+
+	return diff;
+}
+
+void ChunkManager::moveRenderWindow(const glm::vec2& newCenter) {
+	RenderWindowDiff diff = diffRenderWindow(newCenter);
+
+	for (glm::vec2& index : diff.leaving) {
+		removeChunk(index);
+	}
+
+	centerChunk = newCenter;
+	worldChunks->setCenter(newCenter);
+	farTerrain.setCenter(newCenter);
+
+	{
+		std::lock_guard<std::mutex> lock(chunkMutex);
+		lodCenter = newCenter;
+
+		for (glm::vec2& index : diff.entering) {
+			// already prefetched, so it just needs adding
+			auto prefetched = prefetchedChunks.find(index);
+			if (prefetched != prefetchedChunks.end()) {
+				storeChunk(prefetched->second);
+				prefetchedChunks.erase(prefetched);
+				prefetchHits++;
+				continue;
+			}
+
+			// still being prefetched, so bump it to normal priority if it hasn't started yet
+			if (prefetchRequests.erase(index) > 0) {
+				auto queued = std::find(indexToPrefetch.begin(), indexToPrefetch.end(), index);
+				if (queued == indexToPrefetch.end()) {
+					continue;
+				}
+
+				indexToPrefetch.erase(queued);
+			}
+
+			indexToLoad.push(index);
+		}
+	}
+
+	// chunks that crossed into another LOD band are re-meshed, the old mesh is drawn until then
+	if (lodDistance > 0) {
+		worldChunks->forEach([&](const glm::vec2& index, Chunk* c) {
+			if (c->getLod() != getLodFor(index, centerChunk)) {
+				requestLodChange(c);
+			}
+		});
+	}
+}
+
+void ChunkManager::requestLodChange(Chunk* c) {
+	glm::vec2 index = c->getChunkIndex();
+	if (!lodRequests.try_emplace(index, c->getEditCount()).second) {
+		return;
+	}
+
+	// generated chunks come out the same again, edited ones are re-meshed from a copy of their blocks.
+	// Copied before locking, the loading thread only waits for the hand-over.
+	CachedChunk source;
+	if (c->hasEdits()) {
+		c->cacheBlocksTo(source);
+	}
+
 	std::lock_guard<std::mutex> lock(chunkMutex);
 
-	delete worldChunks[chunkIndex];
-	worldChunks.erase(chunkIndex);
+	if (c->hasEdits()) {
+		lodSources[index] = std::move(source);
+	}
+
+	indexToLoad.push(index);
 }
 
-void ChunkManager::addChunk(const glm::vec2& chunkIndex) {
+uint8_t ChunkManager::getLodFor(const glm::vec2& chunkIndex, const glm::vec2& windowCenter) const {
+	glm::vec2 offset = glm::abs(chunkIndex - windowCenter);
+	return lodForDistance((int)std::max(offset.x, offset.y), lodDistance);
+}
+
+void ChunkManager::setFarTerrainDistance(int chunks) {
+	farTerrainDistance = chunks;
+	farTerrain.setRange(windowRadius, farTerrainDistance);
+}
+
+FarTerrainStats ChunkManager::getFarTerrainStats() const {
+	return farTerrain.getStats();
+}
+
+void ChunkManager::setLodDistance(int chunks) {
 	std::lock_guard<std::mutex> lock(chunkMutex);
-	
-	indexToLoad.push(chunkIndex);
+
+	lodDistance = chunks;
+}
+
+bool ChunkManager::isInRenderWindow(const glm::vec2& chunkIndex) const {
+	return isInWindow(chunkIndex, centerChunk);
+}
+
+bool ChunkManager::isInWindow(const glm::vec2& chunkIndex, const glm::vec2& windowCenter) const {
+	glm::vec2 offset = glm::abs(chunkIndex - windowCenter);
+	return offset.x < (float)windowRadius && offset.y < (float)windowRadius;
 }
 
-void ChunkManager::checkForLoadedChunks() {
+void ChunkManager::prefetchChunks(const glm::vec3& camPos, const glm::vec3& camVelocity) {
+	if (prefetchMs <= 0) {
+		return;
+	}
+
+	glm::vec2 predicted = Chunk::posToChunkIndex(camPos + camVelocity * ((float)prefetchMs / 1'000.f));
+	if (predicted == predictedChunk) {
+		return;
+	}
+
+	predictedChunk = predicted;
+
+	// stashed chunks that are in neither window won't be needed any time soon
+	for (auto itr = prefetchedChunks.begin(); itr != prefetchedChunks.end();) {
+		if (!isInRenderWindow(itr->first) && !isInWindow(itr->first, predictedChunk)) {
+			discardChunk(itr->second);
+			itr = prefetchedChunks.erase(itr);
+		}
+		else {
+			itr++;
+		}
+	}
+
 	std::lock_guard<std::mutex> lock(chunkMutex);
 
-	while (!loadedChunks.empty()) {
-		Chunk* c = loadedChunks.front();
+	// the camera changed course, so drop prefetches that haven't started
+	std::erase_if(indexToPrefetch, [&](const glm::vec2& index) {
+		if (isInWindow(index, predictedChunk)) {
+			return false;
+		}
+
+		prefetchRequests.erase(index);
+		return true;
+	});
+
+	// request the squares of the predicted window that aren't covered yet
+	for (int x = 1 - windowRadius; x < windowRadius; x++) {
+		for (int y = 1 - windowRadius; y < windowRadius; y++) {
+			glm::vec2 index = predictedChunk + glm::vec2(x, y);
+
+			if (isInRenderWindow(index) || prefetchedChunks.contains(index) || prefetchRequests.contains(index)) {
+				continue;
+			}
+
+			indexToPrefetch.push_back(index);
+			prefetchRequests.insert(index);
+		}
+	}
+}
+
+void ChunkManager::setPrefetchTime(int milliseconds) {
+	prefetchMs = milliseconds;
+}
+
+size_t ChunkManager::getMissingChunkCount() {
+	size_t windowSize = (size_t)(2 * windowRadius - 1);
+	return windowSize * windowSize - chunkCount();
+}
+
+size_t ChunkManager::getPrefetchedCount() const {
+	return prefetchedChunks.size();
+}
+
+size_t ChunkManager::getPrefetchHits() const {
+	return prefetchHits;
+}
+
+void ChunkManager::checkForLoadedChunks(float budgetMs) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+	int uploadedBytes = 0;
+	bool uploadedAny = false;
+
+	while (Chunk** next = loadedChunks.front()) {
+		Chunk* c = *next;
+
+		// always upload at least one chunk, so big chunks can't stall the queue
+		if (uploadedAny) {
+			int chunkBytes = (int)c->getUploadSize();
+
+			bool overTime = isOverBudget(t_start, budgetMs);
+			bool overBytes = uploadBudgetBytes >= 0 && uploadedBytes + chunkBytes > uploadBudgetBytes;
+			if (overTime || overBytes) {
+				break; // the rest rolls over to next frame
+			}
+		}
 
 		loadedChunks.pop();
 
+		glm::vec2 index = c->getChunkIndex();
+		bool wasPrefetched = prefetchRequests.erase(index) > 0;
+
+		// a re-mesh only replaces the chunk it was made from, and only if that wasn't edited in the meantime
+		auto lodRequest = lodRequests.find(index);
+		if (lodRequest != lodRequests.end()) {
+			uint32_t requestedEdits = lodRequest->second;
+			lodRequests.erase(lodRequest);
+
+			Chunk* live = worldChunks->get(index);
+			if (live == nullptr) {
+				// the live chunk went to the cache when it was removed, so this copy has nothing to add
+				chunkPool.release(c);
+				continue;
+			}
+
+			if (live->getEditCount() != requestedEdits || live->hasPendingChanges()) {
+				chunkPool.release(c);
+
+				if (live->getLod() != getLodFor(index, centerChunk)) {
+					requestLodChange(live);
+				}
+				continue;
+			}
+		}
+
+		// the camera may have moved on while this chunk was loading,
+		// prefetched chunks are kept if they are still ahead of the camera
+		bool keepPrefetched = wasPrefetched && isInWindow(index, predictedChunk);
+		if (!isInRenderWindow(index) && !keepPrefetched) {
+			discardChunk(c);
+			continue;
+		}
+
+		uploadedBytes += (int)c->getUploadSize();
+		uploadedAny = true;
 		c->init();
-		worldChunks[c->getChunkIndex()] = c;
+
+		if (isInRenderWindow(index)) {
+			storeChunk(c);
+
+			// the camera moved on while it was being meshed
+			if (c->getLod() != getLodFor(index, centerChunk)) {
+				requestLodChange(c);
+			}
+		}
+		else {
+			// the stashed chunk was loaded first, so it is the one holding any cached edits
+			if (!prefetchedChunks.try_emplace(index, c).second) {
+				discardChunk(c);
+			}
+		}
+	}
+
+	flushStaging();
+	publishChunks();
+}
+
+void ChunkManager::storeChunk(Chunk* c) {
+	Chunk* displaced = worldChunks->insert(c->getChunkIndex(), c);
+
+	// a rejected chunk was never published so can go straight away,
+	// a displaced one is retired like any other removed chunk, edits and all
+	if (displaced == c) {
+		discardChunk(c);
+		return;
+	}
+
+	if (displaced) {
+		chunkCache.store(*displaced);
+		farTerrain.summarizeChunk(*displaced);
+		removedChunks.emplace_back(displaced);
+	}
+
+	chunksDirty = true;
+}
+
+void ChunkManager::discardChunk(Chunk* c) {
+	// loading took the chunk out of the cache, so put it back or its edits are lost
+	if (c != nullptr) {
+		chunkCache.store(*c);
+		chunkPool.release(c);
+	}
+}
+
+void ChunkManager::setUploadBudget(int kilobytes) {
+	uploadBudgetBytes = (kilobytes >= 0 ? kilobytes * 1'024 : -1);
+}
+
+size_t ChunkManager::getPendingUploadCount() const {
+	return loadedChunks.size();
+}
+
+ChunkPoolStats ChunkManager::getPoolStats() {
+	return chunkPool.getStats();
+}
+
+void ChunkManager::setCacheBudget(size_t kilobytes) {
+	chunkCache.setBudget(kilobytes * 1'024);
+}
+
+ChunkCacheStats ChunkManager::getCacheStats() {
+	return chunkCache.getStats();
+}
+
+ChunkMeshBuffer& ChunkManager::getMeshBuffer() {
+	return meshBuffer;
+}
+
+RenderCommandList& ChunkManager::getRenderCommands() {
+	return renderCommands;
+}
+
+ChunkMeshBufferStats ChunkManager::getMeshBufferStats() const {
+	return meshBuffer.getStats();
+}
+
+void ChunkManager::setStagingRing(int kilobytes) {
+	if (kilobytes > 0 && uploadRing.load() == nullptr) {
+		uploadRing = new DeviceUploadRing((size_t)kilobytes * 1'024);
+	}
+}
+
+DeviceUploadRing* ChunkManager::getUploadRing() const {
+	return uploadRing.load();
+}
+
+void ChunkManager::flushStaging() {
+	// fences this frames' copies, and frees regions the GPU has finished copying.
+	// Fences belong to the render thread, which issues the copies.
+	if (DeviceUploadRing* ring = uploadRing.load()) {
+		renderCommands.record([ring]() {
+			ring->submit();
+			ring->reclaim();
+		});
+	}
+}
+
+DrawStats ChunkManager::getDrawStats() const {
+	return drawStats;
+}
+
+void ChunkManager::publishChunks() {
+	if (chunksDirty) {
+		const ChunkStorage* oldChunks = publishedChunks.exchange(worldChunks->clone(), std::memory_order_seq_cst);
+
+		EpochReclaimer::retire([this, oldChunks, removed = std::move(removedChunks)]() {
+			delete oldChunks;
+
+			for (Chunk* c : removed) {
+				chunkPool.release(c);
+			}
+		});
+
+		removedChunks.clear();
+		chunksDirty = false;
 	}
 }
 
 void ChunkManager::loadingThreadFunc() {
 	while (shouldLoadChunks) {
 		glm::vec2 index;
+		uint8_t lod = 0;
+		CachedChunk cached;
+		bool isCached = false;
 		{
 			std::lock_guard<std::mutex> lock(chunkMutex);
 
-			if (indexToLoad.empty()) {
+			if (!indexToLoad.empty()) {
+				index = indexToLoad.front();
+				indexToLoad.pop();
+			}
+			else if (!indexToPrefetch.empty()) {
+				index = indexToPrefetch.front();
+				indexToPrefetch.pop_front();
+			}
+			else {
 				continue;
 			}
 
-			index = indexToLoad.front();
-			indexToLoad.pop();
+			lod = getLodFor(index, lodCenter);
+
+			// a re-mesh starts from the live chunks' blocks
+			auto source = lodSources.find(index);
+			if (source != lodSources.end()) {
+				cached = std::move(source->second);
+				lodSources.erase(source);
+				isCached = true;
+			}
 		}
 
-		Chunk* c = new Chunk(index);
+		// a recently unloaded chunk comes back as it was, edits included
+		if (!isCached) {
+			isCached = chunkCache.take(index, cached);
+		}
 
-		{
-			std::lock_guard<std::mutex> lock(chunkMutex);
+		Chunk* c = chunkPool.acquire(index, isCached ? &cached : nullptr, lod);
 
-			loadedChunks.push(c);
+		// the main thread then only has to issue a copy
+		if (DeviceUploadRing* ring = uploadRing.load()) {
+			c->stageMesh(*ring);
 		}
+
+		loadedChunks.push(c);
 	}
 }
@@ -1,17 +1,50 @@
 #pragma once
-#include <map>
 #include <glm/vec2.hpp>
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <map>
+#include <set>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 #include "BlockAttribs.h"
+#include "ChunkStorage.h"
+#include "MPSCQueue.h"
+#include "EpochReclaimer.h"
+#include "ChunkPool.h"
+#include "ChunkCache.h"
+#include "ChunkMeshBuffer.h"
+#include "RenderPacket.h"
+#include "Frustum.h"
+#include "SectionVisibility.h"
+#include "TranslucentSort.h"
+#include "ChunkDrawOrder.h"
+#include "OcclusionBuffer.h"
+#include "FarTerrain.h"
 
 class Chunk;
+class DeviceUploadRing;
 
-struct Vec2Comparator {
-	bool operator()(const glm::vec2& a, const glm::vec2& b) const {
-		return std::tie(a.x, a.y) < std::tie(b.x, b.y);
-	}
+struct RenderWindowDiff {
+	std::vector<glm::vec2> entering = {};
+	std::vector<glm::vec2> leaving = {};
+};
+
+// Read-only view of the chunks as they were last published, safe to use from
+// any thread. Chunks seen through a snapshot stay alive until it is destroyed.
+class ChunkSnapshot
+{
+public:
+	ChunkSnapshot(const std::atomic<const ChunkStorage*>& publishedChunks);
+
+	Chunk* getChunkAtIndex(const glm::vec2& index) const;
+	const BlockType getBlockAtPos(const glm::ivec3& pos) const;
+	size_t chunkCount() const;
+
+private:
+	EpochGuard guard; // entered before 'chunks' is loaded
+	const ChunkStorage* chunks = nullptr;
 };
 
 class ChunkManager {
@@ -27,32 +60,171 @@ public:
 	ChunkManager();
 	~ChunkManager();
 
-	void initChunks(uint8_t renderDistance);
-	void updateChunks();
-	void renderChunks();
+	void initChunks(uint8_t renderDistance, bool useRingStorage = false);
+	// Deferred work, each stops once its budget is used up and carries the rest over
+	// to the next call. A negative budget means no limit, and at least one item is always done.
+	void checkForLoadedChunks(float budgetMs = -1.f);
+	void updateChunks(float budgetMs = -1.f);
+	void swapMeshes(float budgetMs = -1.f);
+	void collectGarbage(float budgetMs = -1.f);
+	void updateFarTerrain(float budgetMs = -1.f);
+
+	// Records draws for the chunks and sections that are inside the view frustum into 'packet',
+	// skipping face directions that point away from 'eyePos'. GL work recorded since the last call goes with it.
+	void renderChunks(const glm::mat4& viewProj, const glm::vec3& eyePos, RenderPacket& packet);
 
+	// main thread only, other threads should read through getSnapshot()
 	size_t chunkCount();
 	const size_t getFaceCount() const;
 	Chunk * getChunkAtIndex(const glm::vec2 & index);
-	const std::pair<const glm::vec2, Chunk*>& at(size_t index) const;
+
+	// safe from any thread
+	ChunkSnapshot getSnapshot() const;
 	const BlockType getBlockAtPos(const glm::ivec3& pos) const;
 
 	void removeChunk(glm::vec2& chunkIndex);
 	void addChunk(const glm::vec2 & chunkIndex);
 
-	void checkForLoadedChunks();
+	// @returns The chunks that enter / leave render distance if the camera moves to 'newCenter',
+	// linear in the number of loaded chunks
+	RenderWindowDiff diffRenderWindow(const glm::vec2& newCenter) const;
+
+	// Unloads the chunks that left render distance and requests the ones that entered
+	void moveRenderWindow(const glm::vec2& newCenter);
+	bool isInRenderWindow(const glm::vec2& chunkIndex) const;
+
+	// Requests chunks at low priority around where the camera is predicted
+	// to be in 'prefetchMs', so they are ready when it crosses the border
+	void prefetchChunks(const glm::vec3& camPos, const glm::vec3& camVelocity);
+	void setPrefetchTime(int milliseconds);
+
+	// @returns The number of squares in render distance that have no chunk yet
+	size_t getMissingChunkCount();
+	size_t getPrefetchedCount() const;
+	size_t getPrefetchHits() const;
+
+	// Limits how much chunk data checkForLoadedChunks uploads per call,
+	// a negative budget means no limit
+	void setUploadBudget(int kilobytes);
+	size_t getPendingUploadCount() const;
+	ChunkPoolStats getPoolStats();
+
+	// Unloaded chunks are kept compressed up to this budget, 0 disables the cache
+	void setCacheBudget(size_t kilobytes);
+	ChunkCacheStats getCacheStats();
+
+	// main thread only
+	ChunkMeshBuffer& getMeshBuffer();
+	RenderCommandList& getRenderCommands(); // run on the render thread before the next frame is drawn
+	ChunkMeshBufferStats getMeshBufferStats() const;
+
+	// Creates the ring loaded chunks are staged in, so uploading them is only a GPU copy.
+	// Call once, on the main thread after GL is loaded. 0 disables staging.
+	void setStagingRing(int kilobytes);
+	DeviceUploadRing* getUploadRing() const;
+
+	// @returns The counts from the last renderChunks() call
+	DrawStats getDrawStats() const;
+
+	// Skips sections the camera can't see through any connected air (e.g. caves underground)
+	void setCaveCulling(bool enabled);
+
+	// Draws the nearest chunks first, otherwise they're drawn in storage order
+	void setFrontToBack(bool enabled);
+
+	// Fills DrawStats::shadedTiles / coveredTiles each frame, only worth the time when they're shown
+	void setOverdrawEstimate(bool enabled);
+
+	// Skips chunks and sections hidden behind solid terrain near the camera, see OcclusionBuffer
+	void setOcclusionCulling(bool enabled);
+
+	// Chunks this many chunks away are meshed at lower detail, see lodForDistance. 0 disables LODs.
+	void setLodDistance(int chunks);
+
+	// Fills the view out to this many chunks with height-only terrain, see FarTerrain. 0 disables it.
+	void setFarTerrainDistance(int chunks);
+	FarTerrainStats getFarTerrainStats() const;
 
 private:
+	void initRenderState();
+	void buildChunkDraws(const glm::vec3& eyePos);
+	void buildTranslucentDraws(const glm::vec3& eyePos);
+	void estimateOverdraw(const glm::mat4& viewProj, const glm::vec3& eyePos);
+	void cullOccludedSections(const Frustum& frustum, const glm::vec3& eyePos);
+	void cullHiddenChunks(const glm::mat4& viewProj, const glm::vec3& eyePos);
+	void cullHiddenSections();
 	void loadingThreadFunc();
+	void publishChunks();
+	void storeChunk(Chunk* c);
+	void discardChunk(Chunk* c); // for chunks that were never published
+	void flushStaging();
+	bool isInWindow(const glm::vec2& chunkIndex, const glm::vec2& windowCenter) const;
+	uint8_t getLodFor(const glm::vec2& chunkIndex, const glm::vec2& windowCenter) const;
+	void requestLodChange(Chunk* c);
 
 private:
 	static ChunkManager* instance;
 	
-	std::map<glm::vec2, Chunk*, Vec2Comparator> worldChunks = {};
+	// the main threads' working copy, published to other threads as immutable clones
+	ChunkStorage* worldChunks = nullptr;
+	glm::vec2 centerChunk = { 0, 0 };
+	int windowRadius = 1; // render distance, in chunks
+	std::atomic<const ChunkStorage*> publishedChunks = nullptr;
+	std::vector<Chunk*> removedChunks = {};
+	bool chunksDirty = false;
+
+	// declared before the pool, pooled chunks free their ranges when it is destroyed
+	RenderCommandList renderCommands;
+	ChunkMeshBuffer meshBuffer;
+	std::vector<ChunkDraw> chunkDraws = {};
+	std::vector<TranslucentDraw> translucentDraws = {};
+	std::vector<ChunkDraw> sortedTranslucentDraws = {};
+	std::atomic<DeviceUploadRing*> uploadRing = nullptr; // the loading thread stages into it
+	FarTerrain farTerrain;
+	int farTerrainDistance = 0;
+
+	// culling scratch, re-used every frame
+	BoxCuller chunkBoxes, sectionBoxes;
+	std::vector<uint8_t> chunkVisible = {}, sectionVisible = {};
+	std::vector<Chunk*> drawableChunks = {};
+	std::vector<std::pair<Chunk*, int>> drawableSections = {};
+
+	bool frontToBack = true;
+	ChunkDrawOrder chunkOrder;
+	bool overdrawEstimate = false;
+	OverdrawEstimator overdraw;
+
+	bool caveCulling = false;
+	bool occlusionCulling = false;
+	OcclusionBuffer occlusionBuffer;
+	SectionGraph sectionGraph;
+	std::vector<uint8_t> reachableSections = {};
+
+	// resolved once on the first render, instead of looked up by name every frame
+	GLuint chunkProgram = 0, blockTextures = 0;
+	bool renderStateReady = false;
+	DrawStats drawStats;
+
+	ChunkPool chunkPool;
+	ChunkCache chunkCache;
+
+	int prefetchMs = 0;
+	glm::vec2 predictedChunk = { 0, 0 };
+	std::map<glm::vec2, Chunk*, Vec2Comparator> prefetchedChunks = {}; // loaded + uploaded, but outside render distance
+	std::set<glm::vec2, Vec2Comparator> prefetchRequests = {};
+	size_t prefetchHits = 0;
 
 	std::thread loadingThread;
 	bool shouldLoadChunks = true;
 	std::queue<glm::vec2> indexToLoad = {};
-	std::queue<Chunk*> loadedChunks = {};
+	std::deque<glm::vec2> indexToPrefetch = {}; // only loaded when indexToLoad is empty
+	MPSCQueue<Chunk*> loadedChunks;
 	std::mutex chunkMutex;
+
+	int uploadBudgetBytes = -1;
+
+	int lodDistance = 0;
+	glm::vec2 lodCenter = { 0, 0 }; // the window center the loading thread meshes LODs for, guarded by chunkMutex
+	std::map<glm::vec2, uint32_t, Vec2Comparator> lodRequests = {}; // loaded chunks being re-meshed at another LOD, with their edit count at the time
+	std::map<glm::vec2, CachedChunk, Vec2Comparator> lodSources = {}; // blocks of the edited ones, guarded by chunkMutex
 };
\ No newline at end of file
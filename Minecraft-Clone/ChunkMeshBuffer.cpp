@@ -0,0 +1,133 @@
+#include "ChunkMeshBuffer.h"
+#include "Chunk.h"
+#include "RenderDevice.h"
+#include <algorithm>
+
+ChunkMeshBuffer::ChunkMeshBuffer(RenderCommandList& commandList) : glCommands(commandList) {}
+
+ChunkMeshBuffer::~ChunkMeshBuffer() {
+	if (vao == 0) {
+		return;
+	}
+
+	RenderDevice* device = RenderDevice::getInstance();
+	device->deleteBuffer(faceBuffer);
+	device->deleteBuffer(indirectBuffer);
+	device->deleteBuffer(drawDataBuffer);
+	device->deleteVertexArray(vao);
+}
+
+void ChunkMeshBuffer::upload(FaceRange& range, const FaceData* faces, uint32_t faceCount) {
+	reserve(range, faceCount);
+
+	if (faceCount > 0) {
+		// the faces may change again before the render thread gets to them
+		size_t offset = sizeof(FaceData) * range.offset;
+		glCommands.record([this, offset, faceCopy = std::vector<FaceData>(faces, faces + faceCount)]() {
+			RenderDevice::getInstance()->uploadBuffer(faceBuffer, offset, sizeof(FaceData) * faceCopy.size(), faceCopy.data());
+		});
+	}
+}
+
+void ChunkMeshBuffer::update(const FaceRange& range, uint32_t first, const FaceData* faces, uint32_t faceCount) {
+	if (faceCount == 0 || first + faceCount > range.size) {
+		return;
+	}
+
+	size_t offset = sizeof(FaceData) * (range.offset + first);
+	glCommands.record([this, offset, faceCopy = std::vector<FaceData>(faces, faces + faceCount)]() {
+		RenderDevice::getInstance()->uploadBuffer(faceBuffer, offset, sizeof(FaceData) * faceCopy.size(), faceCopy.data());
+	});
+}
+
+void ChunkMeshBuffer::copyFromStaging(FaceRange& range, GLuint stagingBuffer, size_t stagingOffset, uint32_t faceCount) {
+	reserve(range, faceCount);
+
+	if (faceCount > 0) {
+		size_t offset = sizeof(FaceData) * range.offset;
+		glCommands.record([this, stagingBuffer, stagingOffset, offset, faceCount]() {
+			RenderDevice::getInstance()->copyBuffer(stagingBuffer, stagingOffset, faceBuffer, offset, sizeof(FaceData) * faceCount);
+		});
+	}
+}
+
+void ChunkMeshBuffer::release(FaceRange& range) {
+	allocator.free(range);
+	range = {};
+}
+
+void ChunkMeshBuffer::draw(const std::vector<DrawArraysIndirectCommand>& commands, const std::vector<glm::vec4>& drawData) {
+	if (vao == 0 || commands.empty()) {
+		return;
+	}
+
+	RenderDevice* device = RenderDevice::getInstance();
+
+	// re-specifying the data orphans last frames' buffers, which the GPU may still be reading
+	device->respecifyBuffer(indirectBuffer, sizeof(DrawArraysIndirectCommand) * commands.size(), commands.data(), BufferUsage::STREAM);
+	device->respecifyBuffer(drawDataBuffer, sizeof(glm::vec4) * drawData.size(), drawData.data(), BufferUsage::STREAM);
+	device->bindStorageBuffer(0, drawDataBuffer);
+
+	// the shader pulls each instances' face from here, the quad corners come from gl_VertexID
+	device->bindStorageBuffer(1, faceBuffer);
+
+	device->multiDrawIndirect(vao, indirectBuffer, commands.size());
+}
+
+ChunkMeshBufferStats ChunkMeshBuffer::getStats() const {
+	ChunkMeshBufferStats s;
+	s.usedBytes = sizeof(FaceData) * allocator.getUsed();
+	s.capacityBytes = sizeof(FaceData) * allocator.getCapacity();
+	s.freeBlocks = allocator.getFreeBlockCount();
+	return s;
+}
+
+void ChunkMeshBuffer::initShaderVars() {
+	RenderDevice* device = RenderDevice::getInstance();
+
+	// no attributes, the core profile just needs one bound to draw
+	vao = device->createVertexArray();
+	faceBuffer = device->createBuffer(sizeof(FaceData) * initialCapacity, nullptr, BufferUsage::DYNAMIC);
+
+	// filled every frame by draw()
+	indirectBuffer = device->createBuffer(0, nullptr, BufferUsage::STREAM);
+	drawDataBuffer = device->createBuffer(0, nullptr, BufferUsage::STREAM);
+}
+
+void ChunkMeshBuffer::reserve(FaceRange& range, uint32_t faceCount) {
+	if (allocator.getCapacity() == 0) {
+		allocator.grow(initialCapacity);
+		glCommands.record([this]() { initShaderVars(); });
+	}
+
+	if (faceCount <= range.size) {
+		return;
+	}
+
+	allocator.free(range);
+
+	uint32_t size = (faceCount + rangeGranularity - 1) / rangeGranularity * rangeGranularity;
+	if (!allocator.allocate(size, range)) {
+		grow(size);
+		allocator.allocate(size, range);
+	}
+}
+
+void ChunkMeshBuffer::grow(uint32_t minFaceCount) {
+	uint32_t oldCapacity = allocator.getCapacity();
+	uint32_t newCapacity = std::max(oldCapacity * 2, oldCapacity + minFaceCount);
+	allocator.grow(newCapacity);
+
+	glCommands.record([this, oldCapacity, newCapacity]() { resizeFaceBuffer(oldCapacity, newCapacity); });
+}
+
+void ChunkMeshBuffer::resizeFaceBuffer(uint32_t oldCapacity, uint32_t newCapacity) {
+	RenderDevice* device = RenderDevice::getInstance();
+	GLuint newBuffer = device->createBuffer(sizeof(FaceData) * newCapacity, nullptr, BufferUsage::DYNAMIC);
+
+	// ranges keep their offsets, so the old contents copy straight across
+	device->copyBuffer(faceBuffer, 0, newBuffer, 0, sizeof(FaceData) * oldCapacity);
+
+	device->deleteBuffer(faceBuffer);
+	faceBuffer = newBuffer;
+}
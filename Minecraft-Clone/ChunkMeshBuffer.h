@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <glm/vec4.hpp>
+
+#include "glad/glad.h"
+#include "FaceAllocator.h"
+#include "RenderPacket.h"
+
+struct FaceData;
+
+struct ChunkMeshBufferStats {
+	size_t usedBytes = 0;
+	size_t capacityBytes = 0;
+	size_t freeBlocks = 0;
+};
+
+// Counted per frame, to check rendering stays a handful of GL calls however many chunks are drawn
+struct DrawStats {
+	size_t drawCalls = 0;		// glDraw* calls
+	size_t drawCommands = 0;	// runs of visible sections, several per indirect draw call
+
+	size_t chunks = 0, culledChunks = 0;
+	size_t sections = 0, culledSections = 0; // only counts sections of chunks that passed culling
+	size_t occludedSections = 0; // in the frustum, but not reachable through connected air
+	size_t occluders = 0, hiddenChunks = 0, hiddenSections = 0; // behind solid terrain, see OcclusionBuffer
+	float occlusionMs = 0.f; // rasterizing the occluders and testing against them
+	size_t backFacingFaces = 0; // faces in visible sections skipped for facing away
+	size_t lodChunks = 0; // chunks drawn below full detail
+	size_t farTiles = 0; // far terrain drawn beyond the window
+	size_t reorderedChunks = 0; // places chunks moved to stay sorted front to back
+
+	// estimated fragment work of the opaque draws, see OverdrawEstimator
+	size_t shadedTiles = 0, coveredTiles = 0;
+
+	size_t translucentSections = 0;
+	size_t sortedSections = 0, sortedFaces = 0; // re-sorted for the eye moving across them
+	float translucentSortMs = 0.f; // ordering the sections and re-sorting their faces
+};
+
+// One face buffer shared by every chunk, each chunk owns a range of it.
+// The visible chunks are drawn with a single multi-draw-indirect call.
+// Ranges are handed out on the simulation thread, which records the RenderDevice
+// work into 'commandList' for the render thread, the only one using the device.
+class ChunkMeshBuffer
+{
+public:
+	ChunkMeshBuffer(RenderCommandList& commandList);
+	~ChunkMeshBuffer();
+
+	// Uploads the faces into 'range', re-allocating it if they no longer fit
+	void upload(FaceRange& range, const FaceData* faces, uint32_t faceCount);
+
+	// Overwrites 'faceCount' faces of 'range' from 'first' on, the range itself doesn't change
+	void update(const FaceRange& range, uint32_t first, const FaceData* faces, uint32_t faceCount);
+
+	// Like upload(), but copies faces already written to 'stagingBuffer' on the GPU
+	void copyFromStaging(FaceRange& range, GLuint stagingBuffer, size_t stagingOffset, uint32_t faceCount);
+	void release(FaceRange& range);
+
+	// Render thread only, the commands come from buildDrawCommands()
+	void draw(const std::vector<DrawArraysIndirectCommand>& commands, const std::vector<glm::vec4>& drawData);
+
+	ChunkMeshBufferStats getStats() const;
+
+private:
+	void initShaderVars();
+	void reserve(FaceRange& range, uint32_t faceCount);
+	void grow(uint32_t minFaceCount);
+	void resizeFaceBuffer(uint32_t oldCapacity, uint32_t newCapacity);
+
+private:
+	// initial size in faces, doubled whenever a range doesn't fit
+	static constexpr uint32_t initialCapacity = 1 << 18;
+
+	// ranges are rounded up to this many faces, leaving room for block edits
+	static constexpr uint32_t rangeGranularity = 64;
+
+	// render thread, RenderDevice handles
+	GLuint vao = 0;
+	GLuint faceBuffer = 0, indirectBuffer = 0, drawDataBuffer = 0;
+
+	// simulation thread
+	RenderCommandList& glCommands;
+	FaceAllocator allocator;
+};
@@ -0,0 +1,77 @@
+#include "ChunkPool.h"
+#include "Chunk.h"
+
+ChunkPool::~ChunkPool() {
+	for (Chunk* c : chunks) {
+		delete c;
+	}
+}
+
+Chunk* ChunkPool::acquire(const glm::vec2& chunkIndex, const CachedChunk* cached, uint8_t lod) {
+	Chunk* c = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		if (!chunks.empty()) {
+			c = chunks.back();
+			chunks.pop_back();
+			stats.hits++;
+		}
+		else {
+			stats.misses++;
+		}
+	}
+
+	// generate outside the lock, this is the expensive part
+	if (c) {
+		c->load(chunkIndex, cached, lod);
+		return c;
+	}
+
+	return new Chunk(chunkIndex, cached, lod);
+}
+
+void ChunkPool::release(Chunk* chunk) {
+	if (chunk == nullptr) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		if (chunks.size() < capacity) {
+			// a pooled chunk has nothing to draw, so its face buffer range can go
+			chunk->releaseMesh();
+			chunks.emplace_back(chunk);
+			return;
+		}
+	}
+
+	// deleting frees GL objects, which is why this is main thread only
+	delete chunk;
+}
+
+void ChunkPool::setCapacity(size_t newCapacity) {
+	std::vector<Chunk*> excess = {};
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		capacity = newCapacity;
+		while (chunks.size() > capacity) {
+			excess.emplace_back(chunks.back());
+			chunks.pop_back();
+		}
+	}
+
+	for (Chunk* c : excess) {
+		delete c;
+	}
+}
+
+ChunkPoolStats ChunkPool::getStats() {
+	std::lock_guard<std::mutex> lock(poolMutex);
+
+	ChunkPoolStats s = stats;
+	s.pooled = chunks.size();
+	return s;
+}
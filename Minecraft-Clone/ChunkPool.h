@@ -0,0 +1,41 @@
+#pragma once
+#include <mutex>
+#include <vector>
+#include <glm/vec2.hpp>
+
+class Chunk;
+struct CachedChunk;
+
+struct ChunkPoolStats {
+	size_t hits = 0;	// loads that re-used a pooled chunk
+	size_t misses = 0;	// loads that had to allocate a new chunk
+	size_t pooled = 0;	// chunks currently waiting to be re-used
+
+	float getHitRate() const {
+		size_t total = hits + misses;
+		return total > 0 ? (float)hits / (float)total : 0.f;
+	}
+};
+
+// Keeps retired chunks around, so loading a chunk re-uses their
+// block storage and face vector instead of re-creating them.
+class ChunkPool
+{
+public:
+	~ChunkPool();
+
+	// @returns A chunk loaded at 'chunkIndex' and 'lod' (restored from 'cached' if given), re-used from the pool when possible
+	Chunk* acquire(const glm::vec2& chunkIndex, const CachedChunk* cached = nullptr, uint8_t lod = 0);
+
+	// Returns a chunk to the pool, deleting it if the pool is full. Main thread only.
+	void release(Chunk* chunk);
+
+	void setCapacity(size_t newCapacity);
+	ChunkPoolStats getStats();
+
+private:
+	std::mutex poolMutex;
+	std::vector<Chunk*> chunks = {};
+	size_t capacity = 0;
+	ChunkPoolStats stats;
+};
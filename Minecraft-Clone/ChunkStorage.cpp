@@ -0,0 +1,194 @@
+#include "ChunkStorage.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <glm/glm.hpp>
+
+// ---------- MapChunkStorage ----------
+
+ChunkStorage* MapChunkStorage::clone() const {
+	return new MapChunkStorage(*this);
+}
+
+Chunk* MapChunkStorage::get(const glm::vec2& index) const {
+	auto itr = chunks.find(index);
+	if (itr != chunks.end()) {
+		return itr->second;
+	}
+
+	return nullptr;
+}
+
+Chunk* MapChunkStorage::insert(const glm::vec2& index, Chunk* chunk) {
+	Chunk*& slot = chunks[index];
+	Chunk* displaced = (slot != chunk ? slot : nullptr);
+	slot = chunk;
+
+	return displaced;
+}
+
+Chunk* MapChunkStorage::erase(const glm::vec2& index) {
+	auto itr = chunks.find(index);
+	if (itr == chunks.end()) {
+		return nullptr;
+	}
+
+	Chunk* c = itr->second;
+	chunks.erase(itr);
+
+	return c;
+}
+
+void MapChunkStorage::forEach(const std::function<void(const glm::vec2&, Chunk*)>& func) const {
+	for (auto& c : chunks) {
+		func(c.first, c.second);
+	}
+}
+
+size_t MapChunkStorage::size() const {
+	return chunks.size();
+}
+
+// ---------- RingChunkStorage ----------
+
+RingChunkStorage::RingChunkStorage(uint8_t renderDistance) {
+	windowSize = std::max(2 * (int)renderDistance - 1, 1);
+	slots.resize((size_t)(windowSize * windowSize));
+}
+
+ChunkStorage* RingChunkStorage::clone() const {
+	return new RingChunkStorage(*this);
+}
+
+Chunk* RingChunkStorage::get(const glm::vec2& index) const {
+	glm::ivec2 i = index;
+	const Slot& s = slots[slotFor(i)];
+
+	return (s.chunk != nullptr && s.index == i) ? s.chunk : nullptr;
+}
+
+Chunk* RingChunkStorage::insert(const glm::vec2& index, Chunk* chunk) {
+	glm::ivec2 i = index;
+
+	// a chunk outside the window would evict a live one, so hand it back
+	if (!isInWindow(i)) {
+		return chunk;
+	}
+
+	Slot& s = slots[slotFor(i)];
+	Chunk* displaced = (s.chunk != chunk ? s.chunk : nullptr);
+
+	if (s.chunk == nullptr) {
+		count++;
+	}
+
+	s.index = i;
+	s.chunk = chunk;
+
+	return displaced;
+}
+
+Chunk* RingChunkStorage::erase(const glm::vec2& index) {
+	glm::ivec2 i = index;
+	Slot& s = slots[slotFor(i)];
+
+	if (s.chunk == nullptr || s.index != i) {
+		return nullptr;
+	}
+
+	Chunk* c = s.chunk;
+	s.chunk = nullptr;
+	count--;
+
+	return c;
+}
+
+void RingChunkStorage::forEach(const std::function<void(const glm::vec2&, Chunk*)>& func) const {
+	for (const Slot& s : slots) {
+		if (s.chunk != nullptr) {
+			func(glm::vec2(s.index), s.chunk);
+		}
+	}
+}
+
+size_t RingChunkStorage::size() const {
+	return count;
+}
+
+void RingChunkStorage::setCenter(const glm::vec2& index) {
+	center = index;
+}
+
+size_t RingChunkStorage::slotFor(const glm::ivec2& index) const {
+	int x = ((index.x % windowSize) + windowSize) % windowSize;
+	int y = ((index.y % windowSize) + windowSize) % windowSize;
+
+	return (size_t)(y * windowSize + x);
+}
+
+bool RingChunkStorage::isInWindow(const glm::ivec2& index) const {
+	int halfSize = windowSize / 2;
+	glm::ivec2 offset = glm::abs(index - center);
+
+	return offset.x <= halfSize && offset.y <= halfSize;
+}
+
+// ---------- Benchmark ----------
+
+void ChunkStorage::runBenchmark(uint8_t renderDistance) {
+	const int lookupCount = 1'000'000;
+	const int moveSteps = 256;
+
+	int dist = std::max((int)renderDistance, 1);
+
+	// storages never dereference chunks, so any non-null address will do
+	char dummyByte = 0;
+	Chunk* dummy = reinterpret_cast<Chunk*>(&dummyByte);
+
+	auto timeMs = [](auto&& func) {
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		std::chrono::duration<double, std::milli> t = std::chrono::high_resolution_clock::now() - start;
+		return t.count();
+	};
+
+	auto bench = [&](const char* label, ChunkStorage& storage) {
+		for (int x = -dist + 1; x < dist; x++) {
+			for (int y = -dist + 1; y < dist; y++) {
+				storage.insert({ x, y }, dummy);
+			}
+		}
+
+		size_t hits = 0;
+		double lookupMs = timeMs([&]() {
+			for (int i = 0; i < lookupCount; i++) {
+				glm::vec2 index = { (i * 7) % (2 * dist - 1) - dist + 1, (i * 13) % (2 * dist - 1) - dist + 1 };
+				hits += (storage.get(index) != nullptr);
+			}
+		});
+
+		// walk the camera along +x, swapping the leaving column for the entering one
+		double moveMs = timeMs([&]() {
+			for (int step = 1; step <= moveSteps; step++) {
+				storage.setCenter({ step, 0 });
+				for (int y = -dist + 1; y < dist; y++) {
+					storage.erase({ step - dist, y });
+					storage.insert({ step + dist - 1, y }, dummy);
+				}
+			}
+		});
+
+		std::cout << "\t" << label << " : " << lookupMs << "ms / " << lookupCount << " lookups (" << hits << " hits), "
+			<< moveMs << "ms / " << moveSteps << " chunk moves" << std::endl;
+	};
+
+	std::cout << "<=== Chunk Storage Benchmark (render distance " << dist << ") ===>" << std::endl;
+
+	MapChunkStorage mapStorage;
+	bench("Map ", mapStorage);
+
+	RingChunkStorage ringStorage((uint8_t)dist);
+	bench("Ring", ringStorage);
+
+	std::cout << std::endl;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <functional>
+#include <tuple>
+#include <glm/vec2.hpp>
+
+class Chunk;
+
+struct Vec2Comparator {
+	bool operator()(const glm::vec2& a, const glm::vec2& b) const {
+		return std::tie(a.x, a.y) < std::tie(b.x, b.y);
+	}
+};
+
+// Storage backend for the loaded chunks, keyed by chunk index.
+// Storages never own the chunks, any chunk handed back from
+// insert / erase is the callers' responsibility to delete.
+class ChunkStorage
+{
+public:
+	virtual ~ChunkStorage() = default;
+
+	// @returns A copy of the storage that references the same chunks
+	virtual ChunkStorage* clone() const = 0;
+
+	// @returns The chunk at the index, or nullptr if it isn't loaded
+	virtual Chunk* get(const glm::vec2& index) const = 0;
+
+	// @returns The chunk that could not stay in the storage (displaced or rejected), or nullptr
+	virtual Chunk* insert(const glm::vec2& index, Chunk* chunk) = 0;
+
+	// @returns The chunk that was removed, or nullptr if there was none
+	virtual Chunk* erase(const glm::vec2& index) = 0;
+
+	virtual void forEach(const std::function<void(const glm::vec2&, Chunk*)>& func) const = 0;
+	virtual size_t size() const = 0;
+
+	// Tells the storage which chunk the camera is in
+	virtual void setCenter(const glm::vec2& index) { (void)index; }
+
+	// Times lookups and camera movement for both backends and prints the results
+	static void runBenchmark(uint8_t renderDistance);
+};
+
+class MapChunkStorage : public ChunkStorage
+{
+public:
+	ChunkStorage* clone() const override;
+
+	Chunk* get(const glm::vec2& index) const override;
+	Chunk* insert(const glm::vec2& index, Chunk* chunk) override;
+	Chunk* erase(const glm::vec2& index) override;
+
+	void forEach(const std::function<void(const glm::vec2&, Chunk*)>& func) const override;
+	size_t size() const override;
+
+private:
+	std::map<glm::vec2, Chunk*, Vec2Comparator> chunks = {};
+};
+
+// Fixed (2 * renderDistance - 1)^2 grid that wraps around the camera, a chunk
+// lives in the slot (index mod window size) so lookups are plain arithmetic.
+class RingChunkStorage : public ChunkStorage
+{
+public:
+	RingChunkStorage(uint8_t renderDistance);
+
+	ChunkStorage* clone() const override;
+
+	Chunk* get(const glm::vec2& index) const override;
+	Chunk* insert(const glm::vec2& index, Chunk* chunk) override;
+	Chunk* erase(const glm::vec2& index) override;
+
+	void forEach(const std::function<void(const glm::vec2&, Chunk*)>& func) const override;
+	size_t size() const override;
+
+	void setCenter(const glm::vec2& index) override;
+
+private:
+	struct Slot {
+		glm::ivec2 index = { 0, 0 };
+		Chunk* chunk = nullptr;
+	};
+
+	size_t slotFor(const glm::ivec2& index) const;
+	bool isInWindow(const glm::ivec2& index) const;
+
+private:
+	int windowSize = 1;
+	glm::ivec2 center = { 0, 0 };
+	size_t count = 0;
+	std::vector<Slot> slots = {};
+};
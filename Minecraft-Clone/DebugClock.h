@@ -5,7 +5,7 @@
 
 class DebugClock {
 private:
-#define t_point std::chrono::steady_clock::time_point
+#define t_point std::chrono::high_resolution_clock::time_point
 #define t_now std::chrono::high_resolution_clock::now()
 
 public:
@@ -0,0 +1,30 @@
+#include "DeviceUploadRing.h"
+
+DeviceUploadRing::DeviceUploadRing(size_t ringCapacity) : UploadRing(ringCapacity) {
+	memory = RenderDevice::getInstance()->createMappedBuffer(ringCapacity, buffer);
+}
+
+DeviceUploadRing::~DeviceUploadRing() {
+	// the last copies have to finish before the memory goes
+	RenderDevice::getInstance()->finish();
+	reclaim();
+
+	RenderDevice::getInstance()->deleteBuffer(buffer);
+}
+
+uint8_t* DeviceUploadRing::getMemory() {
+	return memory;
+}
+
+UploadRing::Fence DeviceUploadRing::insertFence() {
+	return RenderDevice::getInstance()->insertFence();
+}
+
+bool DeviceUploadRing::isFenceSignalled(Fence fence) {
+	// only polls, the ring never waits on the GPU
+	return RenderDevice::getInstance()->isFenceSignalled(fence);
+}
+
+void DeviceUploadRing::deleteFence(Fence fence) {
+	RenderDevice::getInstance()->deleteFence(fence);
+}
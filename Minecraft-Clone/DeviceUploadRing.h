@@ -0,0 +1,25 @@
+#pragma once
+#include "RenderDevice.h"
+#include "UploadRing.h"
+
+// UploadRing over a persistently mapped RenderDevice buffer, so any thread can
+// write into it and the render thread copies out of it with copyBuffer().
+// Created before the render thread starts, and destroyed after it stops.
+class DeviceUploadRing : public UploadRing
+{
+public:
+	DeviceUploadRing(size_t ringCapacity);
+	~DeviceUploadRing() override;
+
+	GLuint getBuffer() const { return buffer; }
+
+protected:
+	uint8_t* getMemory() override;
+	Fence insertFence() override;
+	bool isFenceSignalled(Fence fence) override;
+	void deleteFence(Fence fence) override;
+
+private:
+	GLuint buffer = 0;
+	uint8_t* memory = nullptr;
+};
@@ -0,0 +1,134 @@
+#include "EpochReclaimer.h"
+#include <thread>
+#include <limits>
+#include <chrono>
+
+std::atomic<uint64_t> EpochReclaimer::globalEpoch = 1;
+std::atomic<uint64_t> EpochReclaimer::readerEpochs[maxReaders] = {};
+std::atomic<bool> EpochReclaimer::slotsInUse[maxReaders] = {};
+
+std::mutex EpochReclaimer::retiredMutex;
+std::vector<std::pair<uint64_t, std::function<void()>>> EpochReclaimer::retired = {};
+
+// Each reading thread owns one slot for its lifetime
+struct EpochReaderSlot {
+	size_t slot = EpochReclaimer::maxReaders;
+	uint32_t depth = 0;
+
+	~EpochReaderSlot() {
+		if (slot != EpochReclaimer::maxReaders) {
+			EpochReclaimer::releaseSlot(slot);
+		}
+	}
+};
+
+thread_local EpochReaderSlot localSlot;
+
+void EpochReclaimer::enter() {
+	// nested guards share the outermost epoch
+	if (localSlot.depth++ > 0) {
+		return;
+	}
+
+	if (localSlot.slot == maxReaders) {
+		localSlot.slot = claimSlot();
+	}
+
+	// must be visible before the reader loads any shared pointer
+	readerEpochs[localSlot.slot].store(globalEpoch.load(), std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::leave() {
+	if (--localSlot.depth > 0) {
+		return;
+	}
+
+	readerEpochs[localSlot.slot].store(0, std::memory_order_release);
+}
+
+void EpochReclaimer::retire(std::function<void()> deleter) {
+	std::lock_guard<std::mutex> lock(retiredMutex);
+
+	// readers that entered at or before this epoch may still see the data
+	uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+	retired.emplace_back(epoch, std::move(deleter));
+}
+
+size_t EpochReclaimer::collect(float budgetMs) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	// only data retired before the readers are scanned can be judged by that scan
+	size_t retiredCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(retiredMutex);
+		retiredCount = retired.size();
+	}
+
+	uint64_t oldestReader = std::numeric_limits<uint64_t>::max();
+	for (size_t i = 0; i < maxReaders; i++) {
+		uint64_t e = readerEpochs[i].load(std::memory_order_seq_cst);
+		if (e != 0 && e < oldestReader) {
+			oldestReader = e;
+		}
+	}
+
+	std::vector<std::pair<uint64_t, std::function<void()>>> deleters = {};
+	{
+		std::lock_guard<std::mutex> lock(retiredMutex);
+
+		// retired data is in epoch order, so stop at the first one still visible
+		size_t freeCount = 0;
+		while (freeCount < retiredCount && retired[freeCount].first < oldestReader) {
+			deleters.emplace_back(std::move(retired[freeCount]));
+			freeCount++;
+		}
+
+		retired.erase(retired.begin(), retired.begin() + freeCount);
+	}
+
+	// run outside the lock, deleters may retire more data
+	size_t runCount = 0;
+	while (runCount < deleters.size()) {
+		deleters[runCount].second();
+		runCount++;
+
+		std::chrono::duration<float, std::milli> t_elapsed = std::chrono::high_resolution_clock::now() - t_start;
+		if (budgetMs >= 0.f && t_elapsed.count() >= budgetMs) {
+			break;
+		}
+	}
+
+	// out of time, put the rest back in front (they're older than anything retired since)
+	if (runCount < deleters.size()) {
+		std::lock_guard<std::mutex> lock(retiredMutex);
+
+		retired.insert(retired.begin(), std::make_move_iterator(deleters.begin() + runCount), std::make_move_iterator(deleters.end()));
+	}
+
+	return runCount;
+}
+
+size_t EpochReclaimer::getPendingCount() {
+	std::lock_guard<std::mutex> lock(retiredMutex);
+
+	return retired.size();
+}
+
+size_t EpochReclaimer::claimSlot() {
+	while (true) {
+		for (size_t i = 0; i < maxReaders; i++) {
+			bool expected = false;
+			if (slotsInUse[i].compare_exchange_strong(expected, true)) {
+				return i;
+			}
+		}
+
+		// every slot is taken, wait for a reader thread to exit
+		std::this_thread::yield();
+	}
+}
+
+void EpochReclaimer::releaseSlot(size_t slot) {
+	readerEpochs[slot].store(0, std::memory_order_release);
+	slotsInUse[slot].store(false, std::memory_order_release);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Epoch based reclamation for data shared with reader threads.
+// Readers wrap their access in an EpochGuard, writers unpublish
+// data first and then retire it, the deleter only runs once every
+// reader that could still see the data has left its guard.
+class EpochReclaimer
+{
+public:
+	static constexpr size_t maxReaders = 64;
+
+	static void enter();
+	static void leave();
+
+	// Queues 'deleter' to run once no reader can reference the retired data
+	static void retire(std::function<void()> deleter);
+
+	// Runs the deleters that are safe to run, call from the thread that owns the data.
+	// Stops once 'budgetMs' is used up (negative means no limit), the rest wait for the next collect.
+	// @returns The number of deleters that were run
+	static size_t collect(float budgetMs = -1.f);
+
+	static size_t getPendingCount();
+
+private:
+	static size_t claimSlot();
+	static void releaseSlot(size_t slot);
+
+	friend struct EpochReaderSlot;
+
+private:
+	static std::atomic<uint64_t> globalEpoch;
+	static std::atomic<uint64_t> readerEpochs[maxReaders]; // 0 means not reading
+	static std::atomic<bool> slotsInUse[maxReaders];
+
+	static std::mutex retiredMutex;
+	static std::vector<std::pair<uint64_t, std::function<void()>>> retired;
+};
+
+class EpochGuard
+{
+public:
+	EpochGuard() { EpochReclaimer::enter(); }
+	~EpochGuard() { EpochReclaimer::leave(); }
+
+	EpochGuard(const EpochGuard&) = delete;
+	EpochGuard& operator = (const EpochGuard&) = delete;
+};
@@ -0,0 +1,103 @@
+#include "FaceAllocator.h"
+#include <algorithm>
+
+FaceAllocator::FaceAllocator(uint32_t _capacity) {
+	grow(_capacity);
+}
+
+bool FaceAllocator::allocate(uint32_t size, FaceRange& out) {
+	if (size == 0) {
+		out = {};
+		return true;
+	}
+
+	// smallest free block that fits, so big blocks stay big
+	auto best = freeBySize.lower_bound({ size, 0 });
+	if (best == freeBySize.end()) {
+		return false;
+	}
+
+	uint32_t blockOffset = best->second;
+	uint32_t blockSize = best->first;
+	removeFree(freeByOffset.find(blockOffset));
+
+	if (blockSize > size) {
+		addFree(blockOffset + size, blockSize - size);
+	}
+
+	out = { blockOffset, size };
+	used += size;
+	return true;
+}
+
+void FaceAllocator::free(const FaceRange& range) {
+	if (!range.isValid()) {
+		return;
+	}
+
+	uint32_t offset = range.offset;
+	uint32_t size = range.size;
+	used -= size;
+
+	// merge with the free block after...
+	auto next = freeByOffset.find(offset + size);
+	if (next != freeByOffset.end()) {
+		size += next->second;
+		removeFree(next);
+	}
+
+	// ...and the one before
+	auto prev = freeByOffset.lower_bound(offset);
+	if (prev != freeByOffset.begin()) {
+		prev--;
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			removeFree(prev);
+		}
+	}
+
+	addFree(offset, size);
+}
+
+void FaceAllocator::grow(uint32_t newCapacity) {
+	if (newCapacity <= capacity) {
+		return;
+	}
+
+	// freeing the new tail merges it with a free block at the old end
+	FaceRange tail = { capacity, newCapacity - capacity };
+	capacity = newCapacity;
+	used += tail.size;
+	free(tail);
+}
+
+uint32_t FaceAllocator::getLargestFreeBlock() const {
+	return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+void FaceAllocator::addFree(uint32_t offset, uint32_t size) {
+	freeByOffset.emplace(offset, size);
+	freeBySize.emplace(size, offset);
+}
+
+void FaceAllocator::removeFree(std::map<uint32_t, uint32_t>::iterator itr) {
+	freeBySize.erase({ itr->second, itr->first });
+	freeByOffset.erase(itr);
+}
+
+void buildDrawCommands(const std::vector<ChunkDraw>& draws, std::vector<DrawArraysIndirectCommand>& commands, std::vector<glm::vec4>& drawData) {
+	commands.clear();
+	drawData.clear();
+
+	for (const ChunkDraw& d : draws) {
+		uint32_t faceCount = std::min(d.faceCount, d.range.size);
+		if (faceCount == 0) {
+			continue;
+		}
+
+		// 6 vertices per quad, one instance per face
+		commands.push_back({ 6, faceCount, 0, d.range.offset });
+		drawData.push_back({ d.chunkIndex, (float)(1 << d.lod), 0.f });
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+// A run of face slots in the shared face buffer
+struct FaceRange {
+	uint32_t offset = 0;
+	uint32_t size = 0;
+
+	bool isValid() const { return size > 0; }
+};
+
+// Free-list suballocator for the shared face buffer, handing out best-fit
+// ranges of face slots and merging freed ranges with their neighbours.
+// Pure bookkeeping, the GPU buffer itself lives in ChunkMeshBuffer.
+class FaceAllocator
+{
+public:
+	FaceAllocator(uint32_t _capacity = 0);
+
+	// @returns False if no free block is big enough, grow() and try again
+	bool allocate(uint32_t size, FaceRange& out);
+	void free(const FaceRange& range);
+
+	// Adds slots to the end of the buffer, existing ranges keep their offsets
+	void grow(uint32_t newCapacity);
+
+	uint32_t getCapacity() const { return capacity; }
+	uint32_t getUsed() const { return used; }
+	size_t getFreeBlockCount() const { return freeByOffset.size(); }
+	uint32_t getLargestFreeBlock() const;
+
+private:
+	void addFree(uint32_t offset, uint32_t size);
+	void removeFree(std::map<uint32_t, uint32_t>::iterator itr);
+
+private:
+	uint32_t capacity = 0;
+	uint32_t used = 0;
+
+	std::map<uint32_t, uint32_t> freeByOffset = {};				// offset -> size, for merging neighbours
+	std::set<std::pair<uint32_t, uint32_t>> freeBySize = {};	// (size, offset), for best-fit lookups
+};
+
+// Matches the layout glMultiDrawArraysIndirect reads from the indirect buffer
+struct DrawArraysIndirectCommand {
+	uint32_t count = 0;
+	uint32_t instanceCount = 0;
+	uint32_t first = 0;
+	uint32_t baseInstance = 0;
+};
+
+struct ChunkDraw {
+	FaceRange range;
+	uint32_t faceCount = 0;
+	glm::vec2 chunkIndex = { 0, 0 };
+	uint8_t lod = 0;
+};
+
+// Builds one instanced quad draw per chunk with faces, the face range becomes the base instance
+// and the shader pulls face gl_BaseInstance + gl_InstanceID out of the face buffer.
+// 'drawData' gets each commands' (chunk index x, chunk index y, block scale, 0), the shader looks it up by gl_DrawID.
+void buildDrawCommands(const std::vector<ChunkDraw>& draws, std::vector<DrawArraysIndirectCommand>& commands, std::vector<glm::vec4>& drawData);
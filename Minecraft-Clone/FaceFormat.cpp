@@ -0,0 +1,16 @@
+#include "FaceFormat.h"
+
+#include <sstream>
+
+std::string getFaceFormatGlsl() {
+	std::stringstream glsl;
+
+	for (const FaceField& field : faceFields) {
+		glsl << "uint getFace" << field.name << "(uvec2 face) { return (face[" << (int)field.word << "] >> " << (int)field.shift << "u) & " << field.mask() << "u; }\n";
+	}
+
+	glsl << "const uint FACE_MAX_AO = " << (int)maxFaceAO << "u;\n";
+	glsl << "const uint FACE_MAX_LIGHT = " << (int)maxFaceLight << "u;\n";
+
+	return glsl.str();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// A face is packed into two 32-bit words, the chunk shader decodes it with the same fields (see getFaceFormatGlsl)
+//
+// word 0   x: 4 bits   y: 4 bits   z: 8 bits   direction: 3 bits   translucent: 1 bit   texture: 12 bits
+// word 1   AO: 2 bits per quad corner   light: 4 bits   (20 bits spare)
+// TOTAL    64 bits
+constexpr int faceWordCount = 2;
+
+struct FaceField {
+	const char* name = "";
+	uint8_t word = 0;
+	uint8_t shift = 0;
+	uint8_t bits = 0;
+
+	constexpr uint32_t mask() const {
+		return bits >= 32 ? ~0u : (1u << bits) - 1u;
+	}
+};
+
+// the shader reads each field with getFace<name>(uvec2 face)
+constexpr FaceField facePosX        = { "PosX",        0, 0,  4 };
+constexpr FaceField facePosY        = { "PosY",        0, 4,  4 };
+constexpr FaceField facePosZ        = { "PosZ",        0, 8,  8 };
+constexpr FaceField faceDirection   = { "Direction",   0, 16, 3 };
+constexpr FaceField faceTranslucent = { "Translucent", 0, 19, 1 };
+constexpr FaceField faceTexture     = { "Texture",     0, 20, 12 };
+constexpr FaceField faceAO          = { "AO",          1, 0,  8 }; // corner i at bits 2i, corners are counter-clockwise from bottom left
+constexpr FaceField faceLight       = { "Light",       1, 8,  4 };
+
+constexpr FaceField faceFields[] = { facePosX, facePosY, facePosZ, faceDirection, faceTranslucent, faceTexture, faceAO, faceLight };
+
+constexpr int faceCornerCount = 4;
+constexpr uint8_t maxFaceAO = 3; // fully occluded corner
+constexpr uint8_t maxFaceLight = 15;
+
+// the layer index must fit in the texture field
+constexpr uint32_t maxFaceTextures = 1u << faceTexture.bits;
+
+// values are truncated to the fields' width
+constexpr void packFaceField(uint32_t* words, const FaceField& field, uint32_t value) {
+	words[field.word] = (words[field.word] & ~(field.mask() << field.shift)) | ((value & field.mask()) << field.shift);
+}
+
+constexpr uint32_t unpackFaceField(const uint32_t* words, const FaceField& field) {
+	return (words[field.word] >> field.shift) & field.mask();
+}
+
+// @returns GLSL getters for the packed face fields, inserted into shaders after their #version line
+std::string getFaceFormatGlsl();
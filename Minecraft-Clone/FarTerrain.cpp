@@ -0,0 +1,283 @@
+#include "FarTerrain.h"
+#include "Chunk.h"
+#include "ChunkMeshBuffer.h"
+#include "Frustum.h"
+#include "WorldGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+
+constexpr int farCellSize = 1 << farTerrainLod; // in blocks
+constexpr int cellsPerTile = farTileChunks * ((int)chunkSize.x / farCellSize);
+
+static_assert(cellsPerTile <= 16, "Far terrain cells must fit in a faces' position!");
+
+FarTerrain::FarTerrain(ChunkMeshBuffer& _meshBuffer) : meshBuffer(_meshBuffer) {
+}
+
+FarTerrain::~FarTerrain() {
+	for (auto& [index, tile] : tiles) {
+		meshBuffer.release(tile.range);
+	}
+}
+
+void FarTerrain::setRange(int _windowRadius, int _farRadius) {
+	windowRadius = _windowRadius;
+	farRadius = _farRadius;
+
+	for (auto& [index, tile] : tiles) {
+		tile.dirty = true;
+	}
+
+	setCenter(center);
+}
+
+void FarTerrain::setCenter(const glm::vec2& centerChunk) {
+	glm::vec2 oldCenter = center;
+	center = centerChunk;
+
+	for (auto itr = tiles.begin(); itr != tiles.end();) {
+		if (isTileInRing(itr->first)) {
+			itr++;
+			continue;
+		}
+
+		meshBuffer.release(itr->second.range);
+		itr = tiles.erase(itr);
+	}
+
+	// past the far terrain nothing reads them, the cache or the generator covers the chunk if it comes back
+	std::erase_if(summaries, [&](const auto& summary) {
+		glm::vec2 offset = glm::abs(summary.first - center);
+		return offset.x >= (float)farRadius || offset.y >= (float)farRadius;
+	});
+
+	if (farRadius <= 0) {
+		return;
+	}
+
+	glm::vec2 firstTile = glm::floor((center - glm::vec2((float)farRadius - 1.f)) / (float)farTileChunks);
+	glm::vec2 lastTile = glm::floor((center + glm::vec2((float)farRadius - 1.f)) / (float)farTileChunks);
+	for (float x = firstTile.x; x <= lastTile.x; x++) {
+		for (float y = firstTile.y; y <= lastTile.y; y++) {
+			if (isTileInRing({ x, y })) {
+				tiles.try_emplace({ x, y });
+			}
+		}
+	}
+
+	// the cells the window left need faces, the ones it moved over lose them
+	markTilesDirty(oldCenter);
+	markTilesDirty(center);
+}
+
+void FarTerrain::summarizeChunk(const Chunk& c) {
+	if (!c.hasEdits()) {
+		return;
+	}
+
+	ChunkSummary& summary = summaries[c.getChunkIndex()];
+	for (int cx = 0; cx < cellsPerChunk; cx++) {
+		for (int cy = 0; cy < cellsPerChunk; cy++) {
+			// the highest block of any column in the cell
+			int top = -1;
+			for (int x = cx * farCellSize; x < (cx + 1) * farCellSize; x++) {
+				for (int y = cy * farCellSize; y < (cy + 1) * farCellSize; y++) {
+					for (int z = (int)chunkSize.z - 1; z > top; z--) {
+						if (c.getBlockAtIndex({ x, y, z }) != AIR) {
+							top = z;
+							break;
+						}
+					}
+				}
+			}
+
+			summary[(size_t)(cx + cy * cellsPerChunk)] = (int8_t)(top < 0 ? -1 : top / farCellSize);
+		}
+	}
+
+	glm::vec2 tileIndex = glm::floor(c.getChunkIndex() / (float)farTileChunks);
+	auto tile = tiles.find(tileIndex);
+	if (tile != tiles.end()) {
+		tile->second.dirty = true;
+	}
+}
+
+void FarTerrain::update(float budgetMs) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	tileOrder.clear();
+	for (const auto& [index, tile] : tiles) {
+		if (tile.dirty) {
+			glm::vec2 toCenter = (index + 0.5f) * (float)farTileChunks - center;
+			tileOrder.emplace_back(glm::dot(toCenter, toCenter), &index);
+		}
+	}
+
+	std::sort(tileOrder.begin(), tileOrder.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	// the rest keep drawing their old faces until the next update
+	for (size_t i = 0; i < tileOrder.size(); i++) {
+		std::chrono::duration<float, std::milli> t_elapsed = std::chrono::high_resolution_clock::now() - t_start;
+		if (i > 0 && budgetMs >= 0.f && t_elapsed.count() >= budgetMs) {
+			break;
+		}
+
+		meshTile(*tileOrder[i].second, tiles.at(*tileOrder[i].second));
+	}
+
+	std::chrono::duration<float, std::milli> t_update = std::chrono::high_resolution_clock::now() - t_start;
+	lastUpdateMs = tileOrder.empty() ? 0.f : t_update.count();
+	totalMs += lastUpdateMs;
+}
+
+void FarTerrain::meshTile(const glm::vec2& tileIndex, Tile& tile) {
+	glm::ivec2 firstCell = glm::ivec2(tileIndex) * cellsPerTile;
+	glm::vec2 firstChunk = tileIndex * (float)farTileChunks;
+
+	// one cell of border, for the sides facing the neighbouring tiles
+	constexpr int gridSize = cellsPerTile + 2;
+	std::array<int, gridSize * gridSize> heights;
+	for (int x = 0; x < gridSize; x++) {
+		for (int y = 0; y < gridSize; y++) {
+			heights[(size_t)(x + y * gridSize)] = getCellHeight(firstCell + glm::ivec2(x - 1, y - 1));
+		}
+	}
+
+	auto heightAt = [&](int x, int y) {
+		return heights[(size_t)(x + 1 + (y + 1) * gridSize)];
+	};
+
+	faceScratch.clear();
+	tile.topCell = 0;
+
+	for (int x = 0; x < cellsPerTile; x++) {
+		for (int y = 0; y < cellsPerTile; y++) {
+			int height = heightAt(x, y);
+			if (height < 0 || isInWindow(firstChunk + glm::vec2(x, y) / (float)cellsPerChunk)) {
+				continue;
+			}
+
+			auto addFace = [&](int z, BlockType type, BlockFace face) {
+				FaceData f;
+				f.setPosition({ x, y, z });
+				f.setBlockTexId(type, face);
+				f.setDirection(face);
+				faceScratch.push_back(f);
+			};
+
+			addFace(height, GRASS, TOP);
+
+			// walls down to each neighbours' top, the window is filled with the same heights
+			for (BlockFace face : { FRONT, BACK, LEFT, RIGHT }) {
+				int neighbourHeight = heightAt(x + faceNormals[face].x, y + faceNormals[face].y);
+				for (int z = height; z > neighbourHeight; z--) {
+					addFace(z, z == height ? GRASS : DIRT, face);
+				}
+			}
+
+			tile.topCell = std::max(tile.topCell, height);
+		}
+	}
+
+	tile.faceCount = (uint32_t)faceScratch.size();
+	tile.dirty = false;
+
+	if (tile.faceCount > 0) {
+		meshBuffer.upload(tile.range, faceScratch.data(), tile.faceCount);
+	}
+	else {
+		meshBuffer.release(tile.range);
+	}
+}
+
+void FarTerrain::buildDraws(const Frustum& frustum, const glm::vec3& eyePos, std::vector<ChunkDraw>& draws) {
+	tileOrder.clear();
+	for (const auto& [index, tile] : tiles) {
+		if (tile.faceCount == 0) {
+			continue;
+		}
+
+		glm::vec3 tileMin = glm::vec3(index * (float)farTileChunks, 0) * chunkSize + extentsMin;
+		glm::vec3 tileMax = tileMin + glm::vec3(farTileChunks * chunkSize.x, farTileChunks * chunkSize.y, (tile.topCell + 1) * farCellSize);
+		if (!frustum.isBoxVisible(tileMin, tileMax)) {
+			continue;
+		}
+
+		glm::vec2 toEye = glm::vec2(eyePos) - glm::vec2(tileMin + tileMax) * 0.5f;
+		tileOrder.emplace_back(glm::dot(toEye, toEye), &index);
+	}
+
+	std::sort(tileOrder.begin(), tileOrder.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	for (const auto& [distance, index] : tileOrder) {
+		const Tile& tile = tiles.at(*index);
+		draws.push_back({ tile.range, tile.faceCount, *index * (float)farTileChunks, farTerrainLod });
+	}
+}
+
+FarTerrainStats FarTerrain::getStats() const {
+	FarTerrainStats s;
+	s.tiles = tiles.size();
+
+	for (const auto& [index, tile] : tiles) {
+		s.dirtyTiles += tile.dirty;
+		s.faces += tile.faceCount;
+		s.faceBytes += sizeof(FaceData) * tile.range.size;
+	}
+
+	s.summaries = summaries.size();
+	s.summaryBytes = summaries.size() * (sizeof(glm::vec2) + sizeof(ChunkSummary));
+	s.lastUpdateMs = lastUpdateMs;
+	s.totalMs = totalMs;
+	return s;
+}
+
+int FarTerrain::getCellHeight(const glm::ivec2& cell) const {
+	glm::ivec2 chunk = glm::ivec2(glm::floor(glm::vec2(cell) / (float)cellsPerChunk));
+
+	auto summary = summaries.find(glm::vec2(chunk));
+	if (summary != summaries.end()) {
+		glm::ivec2 local = cell - chunk * cellsPerChunk;
+		return summary->second[(size_t)(local.x + local.y * cellsPerChunk)];
+	}
+
+	// the generator is smooth at this scale, the middle of the cell will do
+	glm::vec3 pos = glm::vec3(glm::vec2(cell * farCellSize) + (float)farCellSize * 0.5f, 0);
+	return (int)WorldGenerator::getSurfaceHeightAtPos(pos) / farCellSize;
+}
+
+bool FarTerrain::isInWindow(const glm::vec2& chunkIndex) const {
+	glm::vec2 offset = glm::abs(glm::floor(chunkIndex) - center);
+	return offset.x < (float)windowRadius && offset.y < (float)windowRadius;
+}
+
+bool FarTerrain::isTileInRing(const glm::vec2& tileIndex) const {
+	if (farRadius <= 0) {
+		return false;
+	}
+
+	// chunks of the tile nearest to / furthest from the center
+	glm::vec2 first = tileIndex * (float)farTileChunks;
+	glm::vec2 last = first + (float)(farTileChunks - 1);
+	glm::vec2 nearest = glm::clamp(center, first, last);
+	glm::vec2 furthest = glm::max(glm::abs(first - center), glm::abs(last - center));
+
+	bool touchesRing = glm::all(glm::lessThan(glm::abs(nearest - center), glm::vec2((float)farRadius)));
+	bool insideWindow = glm::all(glm::lessThan(furthest, glm::vec2((float)windowRadius)));
+	return touchesRing && !insideWindow;
+}
+
+void FarTerrain::markTilesDirty(const glm::vec2& windowCenter) {
+	glm::vec2 firstTile = glm::floor((windowCenter - glm::vec2((float)windowRadius - 1.f)) / (float)farTileChunks);
+	glm::vec2 lastTile = glm::floor((windowCenter + glm::vec2((float)windowRadius - 1.f)) / (float)farTileChunks);
+
+	for (float x = firstTile.x; x <= lastTile.x; x++) {
+		for (float y = firstTile.y; y <= lastTile.y; y++) {
+			auto tile = tiles.find({ x, y });
+			if (tile != tiles.end()) {
+				tile->second.dirty = true;
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ChunkStorage.h"
+#include "FaceAllocator.h"
+
+class Chunk;
+class ChunkMeshBuffer;
+struct Frustum;
+struct FaceData;
+
+// Far terrain is meshed as LOD faces of this level, cells of 4x4x4 blocks...
+constexpr uint8_t farTerrainLod = 2;
+
+// ...and a tile is as many chunks as those faces can address, 16x16 cells
+constexpr int farTileChunks = 4;
+
+struct FarTerrainStats {
+	size_t tiles = 0, dirtyTiles = 0;
+	size_t faces = 0;
+	size_t faceBytes = 0; // in the shared face buffer
+	size_t summaries = 0, summaryBytes = 0;
+	float lastUpdateMs = 0.f; // meshing tiles in the last update()
+	float totalMs = 0.f;
+};
+
+// Stand-in terrain between the render window and 'farRadius' chunks out, meshed from
+// WorldGenerator heights without generating any blocks, so distant hills stay visible.
+// Cells inside the render window are left to the chunks. Main thread only.
+class FarTerrain
+{
+public:
+	FarTerrain(ChunkMeshBuffer& _meshBuffer);
+	~FarTerrain();
+
+	// 'windowRadius' is the render distance, a 'farRadius' of 0 turns the far terrain off
+	void setRange(int windowRadius, int farRadius);
+
+	// Tiles that left the ring are dropped along with the edit summaries outside it,
+	// the ones that entered it or that the window moved across are re-meshed
+	void setCenter(const glm::vec2& centerChunk);
+
+	// Records the heights of an edited chunk leaving the window, so its edits show up in the far terrain
+	void summarizeChunk(const Chunk& c);
+
+	// Re-meshes dirty tiles nearest first, a negative budget means no limit
+	void update(float budgetMs = -1.f);
+
+	// Adds a draw per tile with faces in the frustum, nearest first
+	void buildDraws(const Frustum& frustum, const glm::vec3& eyePos, std::vector<ChunkDraw>& draws);
+
+	FarTerrainStats getStats() const;
+
+private:
+	// heights are in cells, -1 where there are no blocks
+	static constexpr int cellsPerChunk = 16 >> farTerrainLod;
+	using ChunkSummary = std::array<int8_t, cellsPerChunk * cellsPerChunk>;
+
+	struct Tile {
+		FaceRange range = {};
+		uint32_t faceCount = 0;
+		int topCell = 0; // the highest cell with a face
+		bool dirty = true;
+	};
+
+	void meshTile(const glm::vec2& tileIndex, Tile& tile);
+	int getCellHeight(const glm::ivec2& cell) const; // in far terrain cells from the world origin
+	bool isInWindow(const glm::vec2& chunkIndex) const;
+	bool isTileInRing(const glm::vec2& tileIndex) const;
+	void markTilesDirty(const glm::vec2& windowCenter);
+
+	ChunkMeshBuffer& meshBuffer;
+	int windowRadius = 1, farRadius = 0;
+	glm::vec2 center = { 0, 0 };
+
+	std::map<glm::vec2, Tile, Vec2Comparator> tiles = {};
+	std::map<glm::vec2, ChunkSummary, Vec2Comparator> summaries = {};
+	std::vector<FaceData> faceScratch = {};
+	std::vector<std::pair<float, const glm::vec2*>> tileOrder = {}; // scratch, tiles by distance
+
+	float lastUpdateMs = 0.f, totalMs = 0.f;
+};
@@ -0,0 +1,94 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+FramePacer::FramePacer(int targetFPS, FrameMode frameMode) : mode(frameMode) {
+	targetFrameMs = 1'000.f / (float)std::max(targetFPS, 1);
+}
+
+void FramePacer::beginFrame() {
+	frameStart = std::chrono::high_resolution_clock::now();
+}
+
+void FramePacer::endFrame() {
+	size_t slot = frameCount % framePacerWindow;
+	sleptMs[slot] = 0.f;
+	spunMs[slot] = 0.f;
+
+	if (mode == FRAME_CAPPED) {
+		auto frameDuration = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<float, std::milli>(targetFrameMs));
+		waitUntil(frameStart + frameDuration);
+	}
+
+	std::chrono::duration<float, std::milli> t_frame = std::chrono::high_resolution_clock::now() - frameStart;
+	frameMs[slot] = t_frame.count();
+	frameCount++;
+}
+
+FramePacerStats FramePacer::getStats() const {
+	FramePacerStats s;
+
+	size_t count = std::min(frameCount, framePacerWindow);
+	if (count == 0) {
+		return s;
+	}
+
+	s.minMs = frameMs[0];
+	s.maxMs = frameMs[0];
+	for (size_t i = 0; i < count; i++) {
+		s.meanMs += frameMs[i];
+		s.minMs = std::min(s.minMs, frameMs[i]);
+		s.maxMs = std::max(s.maxMs, frameMs[i]);
+		s.sleptMs += sleptMs[i];
+		s.spunMs += spunMs[i];
+	}
+
+	s.meanMs /= (float)count;
+	s.sleptMs /= (float)count;
+	s.spunMs /= (float)count;
+
+	float variance = 0.f;
+	for (size_t i = 0; i < count; i++) {
+		variance += (frameMs[i] - s.meanMs) * (frameMs[i] - s.meanMs);
+	}
+
+	s.stdDevMs = std::sqrt(variance / (float)count);
+	return s;
+}
+
+void FramePacer::waitUntil(const std::chrono::high_resolution_clock::time_point& deadline) {
+	size_t slot = frameCount % framePacerWindow;
+	auto t_sleepStart = std::chrono::high_resolution_clock::now();
+
+	// coarse sleep, stopping short of the deadline by how late sleeps tend to wake up
+	std::chrono::duration<float, std::milli> t_left = deadline - t_sleepStart;
+	float sleepMs = t_left.count() - spinMarginMs;
+	if (sleepMs > 0.f) {
+		std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(sleepMs));
+
+		auto t_woken = std::chrono::high_resolution_clock::now();
+		std::chrono::duration<float, std::milli> t_slept = t_woken - t_sleepStart;
+		sleptMs[slot] = t_slept.count();
+
+		// jump up to a late wake-up straight away, ease back down slowly
+		float lateMs = t_slept.count() - sleepMs;
+		if (lateMs > spinMarginMs) {
+			spinMarginMs = lateMs;
+		}
+		else {
+			spinMarginMs += (lateMs - spinMarginMs) * 0.05f;
+		}
+
+		spinMarginMs = std::clamp(spinMarginMs, 0.5f, targetFrameMs);
+	}
+
+	// then spin out the rest
+	auto t_spinStart = std::chrono::high_resolution_clock::now();
+	while (std::chrono::high_resolution_clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+
+	std::chrono::duration<float, std::milli> t_spun = std::chrono::high_resolution_clock::now() - t_spinStart;
+	spunMs[slot] = t_spun.count();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+enum FrameMode : uint8_t {
+	FRAME_CAPPED = 0,	// the pacer waits out the rest of each frame
+	FRAME_VSYNC,		// buffer swaps wait for the display, which holds the simulation back
+	FRAME_UNCAPPED,		// no waiting at all
+
+	FRAME_MODE_COUNT
+};
+
+constexpr std::string_view frameModeNames[FRAME_MODE_COUNT] = { "Capped", "VSync", "Uncapped" };
+
+// Over the last 'framePacerWindow' frames
+struct FramePacerStats {
+	float meanMs = 0.f, stdDevMs = 0.f;
+	float minMs = 0.f, maxMs = 0.f;
+	float sleptMs = 0.f, spunMs = 0.f; // average wait per frame, sleeping frees the core for other threads
+};
+
+constexpr size_t framePacerWindow = 120;
+
+// Ends frames at the target rate without burning a core: sleeps through most
+// of the time left, then spins the last bit, which sleeps are too coarse to hit.
+// How much is left to spinning follows how late sleeps have been waking up.
+class FramePacer
+{
+public:
+	FramePacer(int targetFPS, FrameMode frameMode);
+
+	void beginFrame();
+
+	// Waits out the rest of the frame (capped mode only) and records how long it took
+	void endFrame();
+
+	FrameMode getMode() const { return mode; }
+	float getTargetFrameMs() const { return targetFrameMs; }
+	FramePacerStats getStats() const;
+
+private:
+	void waitUntil(const std::chrono::high_resolution_clock::time_point& deadline);
+
+private:
+	FrameMode mode = FRAME_CAPPED;
+	float targetFrameMs = 16.6f;
+
+	// sleeps wake up this late at worst (give or take), the rest of the wait is spun
+	float spinMarginMs = 2.f;
+
+	std::chrono::high_resolution_clock::time_point frameStart;
+	std::array<float, framePacerWindow> frameMs = {};
+	std::array<float, framePacerWindow> sleptMs = {}, spunMs = {};
+	size_t frameCount = 0;
+};
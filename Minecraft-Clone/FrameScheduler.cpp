@@ -0,0 +1,56 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+
+FrameScheduler::FrameScheduler(int targetFPS) {
+	targetFrameMs = 1'000.f / (float)std::max(targetFPS, 1);
+	totalBudgetMs = targetFrameMs * 0.25f;
+}
+
+void FrameScheduler::beginFrame() {
+	frameStart = std::chrono::high_resolution_clock::now();
+
+	std::fill(std::begin(usedMs), std::end(usedMs), 0.f);
+}
+
+void FrameScheduler::run(FrameTask task, const std::function<void(float)>& func) {
+	auto t_start = std::chrono::high_resolution_clock::now();
+
+	func(getBudgetMs(task));
+
+	std::chrono::duration<float, std::milli> t_taken = std::chrono::high_resolution_clock::now() - t_start;
+	usedMs[task] += t_taken.count();
+}
+
+float FrameScheduler::getBudgetMs(FrameTask task) const {
+	if (frameTaskShares[task] > 0.f) {
+		return totalBudgetMs * frameTaskShares[task];
+	}
+
+	// the headroom, so it never eats into the other tasks' budgets
+	float othersMs = 0.f;
+	for (int i = 0; i < FRAME_TASK_COUNT; i++) {
+		if (i != task) {
+			othersMs += usedMs[i];
+		}
+	}
+
+	return std::max(totalBudgetMs - othersMs, 0.f);
+}
+
+void FrameScheduler::endFrame() {
+	std::chrono::duration<float, std::milli> t_frame = std::chrono::high_resolution_clock::now() - frameStart;
+
+	float scheduledMs = 0.f;
+	for (float used : usedMs) {
+		scheduledMs += used;
+	}
+
+	// time left in the frame once the work we don't schedule is done,
+	// keeping some headroom for frame to frame noise
+	float fixedMs = t_frame.count() - scheduledMs;
+	float spareMs = (targetFrameMs - fixedMs) * 0.75f;
+	float wantedMs = std::clamp(spareMs, minBudgetMs, targetFrameMs);
+
+	// ease towards it, so one slow frame doesn't starve the deferred work
+	totalBudgetMs += (wantedMs - totalBudgetMs) * 0.1f;
+}
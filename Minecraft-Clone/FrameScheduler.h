@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+// Categories of deferred main-thread work, each gets its own slice of the frame
+enum FrameTask : uint8_t {
+	GL_UPLOADS = 0,
+	CHUNK_UPDATES,
+	MESH_SWAPS,
+	GARBAGE_COLLECTION,
+	FAR_TERRAIN,
+
+	FRAME_TASK_COUNT
+};
+
+constexpr std::string_view frameTaskNames[FRAME_TASK_COUNT] = { "GL Uploads", "Chunk Updates", "Mesh Swaps", "Garbage Collection", "Far Terrain" };
+
+// Share of the deferred work budget each task gets. Far terrain has no share of its own,
+// it only gets what the other tasks left unused this frame.
+constexpr float frameTaskShares[FRAME_TASK_COUNT] = { 0.4f, 0.3f, 0.2f, 0.1f, 0.f };
+
+// Hands out per-frame time budgets for deferred work. The total budget follows
+// how much of the target frame time is left once the fixed work (input,
+// rendering, ImGui, etc.) is done, anything that doesn't fit carries over.
+class FrameScheduler
+{
+public:
+	FrameScheduler(int targetFPS);
+
+	void beginFrame();
+
+	// Runs 'func' with this tasks' budget in milliseconds and records how long it took
+	void run(FrameTask task, const std::function<void(float)>& func);
+
+	// Call once the frames' work is done (before waiting for the next frame)
+	void endFrame();
+
+	float getBudgetMs(FrameTask task) const;
+	float getUsedMs(FrameTask task) const { return usedMs[task]; }
+	float getTotalBudgetMs() const { return totalBudgetMs; }
+
+private:
+	float targetFrameMs = 16.6f;
+	float totalBudgetMs = 4.f;
+
+	// the budget never drops below this, so deferred work always makes progress
+	float minBudgetMs = 1.f;
+
+	std::chrono::high_resolution_clock::time_point frameStart;
+	float usedMs[FRAME_TASK_COUNT] = {};
+};
@@ -0,0 +1,110 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_USE_SSE 1
+#endif
+
+Frustum Frustum::fromViewProjection(const glm::mat4& viewProj) {
+	// glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	auto row = [&](int i) {
+		return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+	};
+
+	Frustum f;
+	f.planes[PLANE_LEFT] = row(3) + row(0);
+	f.planes[PLANE_RIGHT] = row(3) - row(0);
+	f.planes[PLANE_BOTTOM] = row(3) + row(1);
+	f.planes[PLANE_TOP] = row(3) - row(1);
+	f.planes[PLANE_NEAR] = row(3) + row(2);
+	f.planes[PLANE_FAR] = row(3) - row(2);
+
+	for (glm::vec4& p : f.planes) {
+		p /= glm::length(glm::vec3(p));
+	}
+
+	return f;
+}
+
+bool Frustum::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+	for (const glm::vec4& p : planes) {
+		// the corner furthest along the normal, if that's outside the whole box is
+		glm::vec3 corner = {
+			p.x >= 0.f ? max.x : min.x,
+			p.y >= 0.f ? max.y : min.y,
+			p.z >= 0.f ? max.z : min.z
+		};
+
+		if (glm::dot(glm::vec3(p), corner) + p.w < 0.f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool canFacesBeVisible(const glm::vec3& normal, const glm::vec3& min, const glm::vec3& max, const glm::vec3& eye) {
+	// a face is visible if the eye is in front of its plane, so test the face
+	// plane furthest back along the normal, that one is the easiest to see
+	glm::vec3 corner = {
+		normal.x >= 0.f ? min.x : max.x,
+		normal.y >= 0.f ? min.y : max.y,
+		normal.z >= 0.f ? min.z : max.z
+	};
+
+	return glm::dot(normal, eye - corner) > 0.f;
+}
+
+void BoxCuller::clear() {
+	minX.clear(); minY.clear(); minZ.clear();
+	maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void BoxCuller::add(const glm::vec3& min, const glm::vec3& max) {
+	minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+	maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+size_t BoxCuller::cull(const Frustum& frustum, std::vector<uint8_t>& visible) const {
+	size_t count = size();
+	visible.assign(count, 1);
+
+	size_t i = 0;
+
+#if FRUSTUM_USE_SSE
+	for (; i + 4 <= count; i += 4) {
+		__m128 outside = _mm_setzero_ps();
+
+		for (const glm::vec4& p : frustum.planes) {
+			// the normals' signs pick the corner per plane, so there's no per-box select
+			const float* cx = (p.x >= 0.f ? maxX.data() : minX.data()) + i;
+			const float* cy = (p.y >= 0.f ? maxY.data() : minY.data()) + i;
+			const float* cz = (p.z >= 0.f ? maxZ.data() : minZ.data()) + i;
+
+			__m128 dist = _mm_set1_ps(p.w);
+			dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p.x), _mm_loadu_ps(cx)));
+			dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p.y), _mm_loadu_ps(cy)));
+			dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p.z), _mm_loadu_ps(cz)));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+		}
+
+		int mask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; lane++) {
+			visible[i + lane] = (uint8_t)(((mask >> lane) & 1) == 0);
+		}
+	}
+#endif
+
+	// whatever doesn't fill a group of four
+	for (; i < count; i++) {
+		visible[i] = (uint8_t)frustum.isBoxVisible({ minX[i], minY[i], minZ[i] }, { maxX[i], maxY[i], maxZ[i] });
+	}
+
+	size_t visibleCount = 0;
+	for (uint8_t v : visible) {
+		visibleCount += v;
+	}
+
+	return visibleCount;
+}
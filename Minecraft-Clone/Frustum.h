@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The six planes of a view frustum, normals point inwards.
+struct Frustum {
+	// prefixed, NEAR / FAR are macros on windows
+	enum Plane : uint8_t { PLANE_LEFT = 0, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+	glm::vec4 planes[PLANE_COUNT] = {}; // xyz => normal, w => distance
+
+	// Extracts the planes from a projection * view matrix (Gribb / Hartmann)
+	static Frustum fromViewProjection(const glm::mat4& viewProj);
+
+	// @returns False only if the box is fully outside one of the planes
+	bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+};
+
+// @returns False if every face with 'normal' inside the box faces away from 'eye'
+bool canFacesBeVisible(const glm::vec3& normal, const glm::vec3& min, const glm::vec3& max, const glm::vec3& eye);
+
+// Axis aligned boxes stored as one array per component,
+// so cull() can test four boxes against a plane at a time.
+class BoxCuller
+{
+public:
+	void clear();
+	void add(const glm::vec3& min, const glm::vec3& max);
+	size_t size() const { return minX.size(); }
+
+	// Sets visible[i] to 1 if box i touches the frustum, 0 otherwise
+	// @returns The number of visible boxes
+	size_t cull(const Frustum& frustum, std::vector<uint8_t>& visible) const;
+
+private:
+	std::vector<float> minX = {}, minY = {}, minZ = {};
+	std::vector<float> maxX = {}, maxY = {}, maxZ = {};
+};
@@ -0,0 +1,289 @@
+#include "GLRenderDevice.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+
+void checkGLError(const char* stmt, const char* fname, int line) {
+	GLenum err = glGetError();
+	if (err != GL_NO_ERROR) {
+		printf("OpenGL error %08x, at %s:%i - for %s\n", err, fname, line, stmt);
+		exit(1);
+	}
+}
+
+#define GL_CHECK(stmt) do { \
+    stmt; \
+    checkGLError(#stmt, __FILE__, __LINE__); \
+} while (0)
+
+static GLenum toGL(BufferUsage usage) {
+	switch (usage) {
+		case BufferUsage::STATIC: return GL_STATIC_DRAW;
+		case BufferUsage::DYNAMIC: return GL_DYNAMIC_DRAW;
+		default: return GL_STREAM_DRAW;
+	}
+}
+
+// ---------- Buffers ----------
+
+GLuint GLRenderDevice::createBuffer(size_t bytes, const void* data, BufferUsage usage) {
+	GLuint buffer = 0;
+	GL_CHECK(glGenBuffers(1, &buffer));
+	GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, data, toGL(usage)));
+
+	liveBuffers++;
+	return buffer;
+}
+
+uint8_t* GLRenderDevice::createMappedBuffer(size_t bytes, GLuint& buffer) {
+	// coherent, so writes show up without explicit flushes
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	GL_CHECK(glGenBuffers(1, &buffer));
+	GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GL_CHECK(glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, nullptr, flags));
+
+	liveBuffers++;
+	return (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)bytes, flags);
+}
+
+void GLRenderDevice::deleteBuffer(GLuint buffer) {
+	// deleting a buffer unmaps it
+	glDeleteBuffers(1, &buffer);
+	liveBuffers -= (buffer != 0);
+}
+
+void GLRenderDevice::uploadBuffer(GLuint buffer, size_t offset, size_t bytes, const void* data) {
+	GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)bytes, data));
+}
+
+void GLRenderDevice::respecifyBuffer(GLuint buffer, size_t bytes, const void* data, BufferUsage usage) {
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, data, toGL(usage));
+	stateChanges++;
+}
+
+void GLRenderDevice::copyBuffer(GLuint source, size_t sourceOffset, GLuint dest, size_t destOffset, size_t bytes) {
+	GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, source));
+	GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, dest));
+	GL_CHECK(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)sourceOffset, (GLintptr)destOffset, (GLsizeiptr)bytes));
+}
+
+// ---------- Vertex arrays ----------
+
+GLuint GLRenderDevice::createVertexArray() {
+	GLuint vertexArray = 0;
+	GL_CHECK(glGenVertexArrays(1, &vertexArray));
+
+	liveVertexArrays++;
+	return vertexArray;
+}
+
+void GLRenderDevice::deleteVertexArray(GLuint vertexArray) {
+	glDeleteVertexArrays(1, &vertexArray);
+	liveVertexArrays -= (vertexArray != 0);
+}
+
+// ---------- Textures ----------
+
+GLuint GLRenderDevice::createTexture2D(int width, int height, const uint8_t* rgb) {
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, rgb);
+
+	// mips are built from the image, so only once it's uploaded
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	liveTextures++;
+	return texture;
+}
+
+GLuint GLRenderDevice::createTextureArray(int size, int layers, int levels) {
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, size, size, layers);
+
+	// tiles repeat on their own, so faces can be tiled across without any UV math
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	liveTextures++;
+	return texture;
+}
+
+void GLRenderDevice::uploadTextureLayer(GLuint texture, int level, int layer, int size, const uint8_t* rgba) {
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void GLRenderDevice::deleteTexture(GLuint texture) {
+	glDeleteTextures(1, &texture);
+	liveTextures -= (texture != 0);
+}
+
+// ---------- Shaders ----------
+
+GLuint GLRenderDevice::createProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+	GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+	if (vertexShader == 0 || fragmentShader == 0) {
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return 0;
+	}
+
+	// Link vertex and fragment shaders to a shader program
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glBindFragDataLocation(program, 0, "fragColor");
+	glLinkProgram(program);
+
+	glDeleteShader(fragmentShader);
+	glDeleteShader(vertexShader);
+
+	livePrograms++;
+	return program;
+}
+
+void GLRenderDevice::deleteProgram(GLuint program) {
+	glDeleteProgram(program);
+	livePrograms -= (program != 0);
+}
+
+void GLRenderDevice::setUniform(GLuint program, const char* name, const glm::mat4& value) {
+	glProgramUniformMatrix4fv(program, glGetUniformLocation(program, name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GLRenderDevice::setUniform(GLuint program, const char* name, GLuint value) {
+	glProgramUniform1ui(program, glGetUniformLocation(program, name), value);
+}
+
+GLuint GLRenderDevice::compileShader(GLenum type, const std::string& source) {
+	const char* src = source.c_str();
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &src, 0); // length 0 means opengl will figure it out for us
+	glCompileShader(shader);
+
+	GLint success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		char infoLog[512];
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
+		std::cerr << "ERROR::" << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") << "_SHADER::COMPILATION_FAILED\n" << infoLog << std::endl;
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+// ---------- State and drawing ----------
+
+void GLRenderDevice::setViewport(int width, int height) {
+	glViewport(0, 0, width, height);
+	stateChanges++;
+}
+
+void GLRenderDevice::setDepthTest(bool enabled) {
+	if (enabled) {
+		glEnable(GL_DEPTH_TEST);
+	}
+	else {
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	stateChanges++;
+}
+
+void GLRenderDevice::setWireframe(bool enabled) {
+	if (enabled) {
+		glDisable(GL_CULL_FACE);
+
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	}
+	else {
+		glEnable(GL_CULL_FACE);
+		glCullFace(GL_BACK);
+
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	}
+
+	stateChanges++;
+}
+
+void GLRenderDevice::setBlending(bool enabled) {
+	if (enabled) {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else {
+		glDisable(GL_BLEND);
+	}
+
+	glDepthMask(enabled ? GL_FALSE : GL_TRUE);
+	stateChanges++;
+}
+
+void GLRenderDevice::clear(const glm::vec4& color) {
+	glClearColor(color.r, color.g, color.b, color.a);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void GLRenderDevice::useProgram(GLuint program) {
+	glUseProgram(program);
+	stateChanges++;
+}
+
+void GLRenderDevice::bindTextureArray(GLuint texture) {
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	stateChanges++;
+}
+
+void GLRenderDevice::bindStorageBuffer(GLuint index, GLuint buffer) {
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, buffer);
+	stateChanges++;
+}
+
+void GLRenderDevice::multiDrawIndirect(GLuint vertexArray, GLuint indirectBuffer, size_t commandCount) {
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, (GLsizei)commandCount, 0);
+	glBindVertexArray(0);
+	stateChanges += 2; // vertex array, indirect buffer
+}
+
+// ---------- Sync ----------
+
+RenderDevice::Fence GLRenderDevice::insertFence() {
+	return (Fence)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool GLRenderDevice::isFenceSignalled(Fence fence) {
+	// a zero timeout only polls, nothing here ever waits on the GPU
+	GLenum result = glClientWaitSync((GLsync)fence, 0, 0);
+	return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void GLRenderDevice::deleteFence(Fence fence) {
+	glDeleteSync((GLsync)fence);
+}
+
+void GLRenderDevice::finish() {
+	glFinish();
+}
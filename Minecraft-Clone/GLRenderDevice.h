@@ -0,0 +1,45 @@
+#pragma once
+#include "RenderDevice.h"
+
+// RenderDevice on the current OpenGL 4.6 context
+class GLRenderDevice : public RenderDevice
+{
+public:
+	GLuint createBuffer(size_t bytes, const void* data, BufferUsage usage) override;
+	uint8_t* createMappedBuffer(size_t bytes, GLuint& buffer) override;
+	void deleteBuffer(GLuint buffer) override;
+	void uploadBuffer(GLuint buffer, size_t offset, size_t bytes, const void* data) override;
+	void respecifyBuffer(GLuint buffer, size_t bytes, const void* data, BufferUsage usage) override;
+	void copyBuffer(GLuint source, size_t sourceOffset, GLuint dest, size_t destOffset, size_t bytes) override;
+
+	GLuint createVertexArray() override;
+	void deleteVertexArray(GLuint vertexArray) override;
+
+	GLuint createTexture2D(int width, int height, const uint8_t* rgb) override;
+	GLuint createTextureArray(int size, int layers, int levels) override;
+	void uploadTextureLayer(GLuint texture, int level, int layer, int size, const uint8_t* rgba) override;
+	void deleteTexture(GLuint texture) override;
+
+	GLuint createProgram(const std::string& vertexSource, const std::string& fragmentSource) override;
+	void deleteProgram(GLuint program) override;
+	void setUniform(GLuint program, const char* name, const glm::mat4& value) override;
+	void setUniform(GLuint program, const char* name, GLuint value) override;
+
+	void setViewport(int width, int height) override;
+	void setDepthTest(bool enabled) override;
+	void setWireframe(bool enabled) override;
+	void setBlending(bool enabled) override;
+	void clear(const glm::vec4& color) override;
+	void useProgram(GLuint program) override;
+	void bindTextureArray(GLuint texture) override;
+	void bindStorageBuffer(GLuint index, GLuint buffer) override;
+	void multiDrawIndirect(GLuint vertexArray, GLuint indirectBuffer, size_t commandCount) override;
+
+	Fence insertFence() override;
+	bool isFenceSignalled(Fence fence) override;
+	void deleteFence(Fence fence) override;
+	void finish() override;
+
+private:
+	static GLuint compileShader(GLenum type, const std::string& source);
+};
@@ -0,0 +1,105 @@
+#include "LodMesher.h"
+#include <chrono>
+#include <iostream>
+
+void generateLodFaces(const BlockGrid& blocks, uint8_t lod, std::vector<FaceData>& out) {
+	const int n = 1 << lod;
+	const glm::ivec3 cells = glm::ivec3(chunkSize) / n;
+
+	auto cellIndex = [&](const glm::ivec3& c) {
+		return (size_t)(c.x + cells.x * (c.y + cells.y * c.z));
+	};
+
+	// downsample, the highest solid block in each cell decides its type
+	std::vector<BlockType> coarse((size_t)(cells.x * cells.y * cells.z), AIR);
+	for (int cx = 0; cx < cells.x; cx++) {
+		for (int cy = 0; cy < cells.y; cy++) {
+			for (int cz = 0; cz < cells.z; cz++) {
+				BlockType type = AIR;
+				int topZ = -1;
+
+				for (int x = cx * n; x < (cx + 1) * n; x++) {
+					for (int y = cy * n; y < (cy + 1) * n; y++) {
+						for (int z = (cz + 1) * n - 1; z > topZ && z >= cz * n; z--) {
+							if (blocks[x][y][z] != AIR) {
+								type = blocks[x][y][z];
+								topZ = z;
+							}
+						}
+					}
+				}
+
+				coarse[cellIndex({ cx, cy, cz })] = type;
+			}
+		}
+	}
+
+	for (int cx = 0; cx < cells.x; cx++) {
+		for (int cy = 0; cy < cells.y; cy++) {
+			for (int cz = 0; cz < cells.z; cz++) {
+				glm::ivec3 cell = { cx, cy, cz };
+				BlockType type = coarse[cellIndex(cell)];
+				if (type == AIR) {
+					continue;
+				}
+
+				for (uint8_t i = 0; i < FACE_COUNT; i++) {
+					glm::ivec3 neighbour = cell + faceNormals[i];
+
+					// nothing ever sees the bottom of the world
+					if (neighbour.z < 0) {
+						continue;
+					}
+
+					bool outside = glm::any(glm::lessThan(neighbour, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(neighbour, cells));
+					if (!outside && !isBlockFaceVisible(type, coarse[cellIndex(neighbour)])) {
+						continue;
+					}
+
+					FaceData f;
+					f.setPosition(cell);
+					f.setBlockTexId(type, (BlockFace)i);
+					f.setDirection((BlockFace)i);
+					out.emplace_back(f);
+				}
+			}
+		}
+	}
+}
+
+uint8_t lodForDistance(int chunkDistance, int lodDistance) {
+	if (lodDistance <= 0 || chunkDistance < lodDistance) {
+		return 0;
+	}
+
+	uint8_t lod = 1;
+	for (int bandEnd = lodDistance * 2; chunkDistance >= bandEnd && lod < maxLod; bandEnd *= 2) {
+		lod++;
+	}
+
+	return lod;
+}
+
+void runLodBenchmark(uint8_t renderDistance) {
+	int dist = std::max((int)renderDistance, 1);
+
+	std::cout << "<=== LOD Benchmark (" << (2 * dist - 1) * (2 * dist - 1) << " chunks) ===>" << std::endl;
+
+	for (uint8_t lod = 0; lod <= maxLod; lod++) {
+		size_t faces = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int x = -dist + 1; x < dist; x++) {
+			for (int y = -dist + 1; y < dist; y++) {
+				Chunk c({ x, y }, nullptr, lod);
+				faces += c.getFaceCount();
+			}
+		}
+		std::chrono::duration<double, std::milli> t = std::chrono::high_resolution_clock::now() - start;
+
+		std::cout << "\tLOD " << (int)lod << " (" << (1 << lod) << "x) : " << faces << " faces, "
+			<< (sizeof(FaceData) * faces) / 1'024.f << "kb face data, " << t.count() << "ms" << std::endl;
+	}
+
+	std::cout << std::endl;
+}
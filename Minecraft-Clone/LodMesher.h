@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Chunk.h"
+
+constexpr uint8_t maxLod = 3; // 8x8x8 blocks per cell
+
+// blocks[x][y][z], as stored by Chunk
+using BlockGrid = std::vector<std::vector<std::vector<BlockType>>>;
+
+// Meshes 'blocks' at 1 / 2^lod resolution, face positions are in cells of 2^lod blocks.
+// A cell is solid if any of its blocks is, so far terrain never sinks below the real one,
+// and it takes the type of its highest solid block so grass stays on top.
+// Faces on the chunk border are always kept, which closes the seams between chunks at different LODs.
+void generateLodFaces(const BlockGrid& blocks, uint8_t lod, std::vector<FaceData>& out);
+
+// @returns The LOD for a chunk 'chunkDistance' chunks (on either axis) from the camera.
+// Each level covers twice the distance of the last, so neighbouring chunks never differ by more than one.
+// A 'lodDistance' of 0 or less keeps everything at full detail.
+uint8_t lodForDistance(int chunkDistance, int lodDistance);
+
+// Meshes the chunks around the origin at every LOD and prints their face counts and memory
+void runLodBenchmark(uint8_t renderDistance);
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Unbounded lock-free multi-producer / single-consumer queue.
+// Any thread may push, but only one thread may call front / pop.
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() {
+		Node* stub = new Node();
+		head.store(stub, std::memory_order_relaxed);
+		tail = stub;
+	}
+
+	~MPSCQueue() {
+		while (pop()) {}
+		delete tail;
+	}
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator = (const MPSCQueue&) = delete;
+
+	void push(T value) {
+		Node* n = new Node();
+		n->value = std::move(value);
+
+		// counted before the node becomes visible, so a pop can never take the count below zero
+		count.fetch_add(1, std::memory_order_relaxed);
+
+		// link the new node after whichever node was the previous head
+		Node* prev = head.exchange(n, std::memory_order_acq_rel);
+		prev->next.store(n, std::memory_order_release);
+	}
+
+	// @returns The oldest value without removing it, or nullptr if the queue is empty
+	T* front() {
+		Node* next = tail->next.load(std::memory_order_acquire);
+		return next ? &next->value : nullptr;
+	}
+
+	bool pop(T* out = nullptr) {
+		Node* next = tail->next.load(std::memory_order_acquire);
+		if (next == nullptr) {
+			return false;
+		}
+
+		if (out) {
+			*out = std::move(next->value);
+		}
+
+		// 'next' becomes the new stub node
+		delete tail;
+		tail = next;
+
+		count.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool empty() const {
+		return tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+	// @returns The approximate number of queued values
+	size_t size() const {
+		return count.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Node {
+		std::atomic<Node*> next = nullptr;
+		T value = {};
+	};
+
+	std::atomic<Node*> head;
+	Node* tail = nullptr;
+	std::atomic<size_t> count = 0;
+};
@@ -0,0 +1,257 @@
+#include "OcclusionBuffer.h"
+#include "Chunk.h"
+#include "Frustum.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE 1
+#endif
+
+static_assert(OcclusionBuffer::width % 4 == 0, "Rows are rasterized four pixels at a time!");
+
+OcclusionBuffer::OcclusionBuffer() {
+	depths.assign((size_t)(width * height), 0.f);
+}
+
+void OcclusionBuffer::begin(const glm::mat4& _viewProj) {
+	viewProj = _viewProj;
+	std::fill(depths.begin(), depths.end(), 0.f);
+}
+
+bool OcclusionBuffer::projectCorners(const glm::vec3& min, const glm::vec3& max, glm::vec3* corners) const {
+	// corner i takes max on axis n if bit n of i is set
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+		glm::vec4 clip = viewProj * glm::vec4(corner, 1.f);
+
+		if (clip.w <= 0.01f) {
+			return false;
+		}
+
+		float invW = 1.f / clip.w;
+		corners[i] = { (clip.x * invW * 0.5f + 0.5f) * width, (clip.y * invW * 0.5f + 0.5f) * height, invW };
+	}
+
+	return true;
+}
+
+bool OcclusionBuffer::addOccluder(const glm::vec3& min, const glm::vec3& max, const glm::vec3& eyePos) {
+	glm::vec3 corners[8];
+	if (!projectCorners(min, max, corners)) {
+		return false;
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		// only the side the eye is outside of faces it, neither does if it's between them
+		int side = 0;
+		if (eyePos[axis] > max[axis]) {
+			side = 1 << axis;
+		}
+		else if (eyePos[axis] >= min[axis]) {
+			continue;
+		}
+
+		// as a whole quad, two triangles would each leave out the pixels along their shared diagonal
+		int u = 1 << ((axis + 1) % 3);
+		int v = 1 << ((axis + 2) % 3);
+		rasterizeQuad(corners[side], corners[side | u], corners[side | u | v], corners[side | v]);
+	}
+
+	return true;
+}
+
+void OcclusionBuffer::rasterizeQuad(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d) {
+	// a projected box side is convex, it's flat on screen when seen edge on
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (std::abs(area) < 1e-6f) {
+		return;
+	}
+
+	// counter-clockwise, so each edge function is positive inside
+	if (area < 0.f) {
+		std::swap(b, d);
+		area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	}
+
+	int x0 = std::max((int)std::floor(std::min({ a.x, b.x, c.x, d.x })), 0);
+	int x1 = std::min((int)std::ceil(std::max({ a.x, b.x, c.x, d.x })), width - 1);
+	int y0 = std::max((int)std::floor(std::min({ a.y, b.y, c.y, d.y })), 0);
+	int y1 = std::min((int)std::ceil(std::max({ a.y, b.y, c.y, d.y })), height - 1);
+	if (x0 > x1 || y0 > y1) {
+		return;
+	}
+
+	// edge p -> q as e(x, y) = dx * x + dy * y + k, tested at pixel centers. Moving each edge in by
+	// its value across half a pixel makes the test pass only if the pixels' worst corner is inside.
+	glm::vec3 edges[4];
+	const glm::vec3* verts[4] = { &a, &b, &c, &d };
+	for (int i = 0; i < 4; i++) {
+		const glm::vec3& p = *verts[i];
+		const glm::vec3& q = *verts[(i + 1) % 4];
+		edges[i] = { p.y - q.y, q.x - p.x, (q.y - p.y) * p.x - (q.x - p.x) * p.y };
+		edges[i].z -= 0.5f * (std::abs(edges[i].x) + std::abs(edges[i].y));
+	}
+
+	// 1 / w as a plane over the screen, the side is flat so any three corners give it.
+	// Like the edges it's taken at the pixels' furthest corner, so it never ends up nearer than the side.
+	float zdx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+	float zdy = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+	float zk = a.z - zdx * a.x - zdy * a.y - 0.5f * (std::abs(zdx) + std::abs(zdy));
+
+	x0 &= ~3; // rows start on a group of four, pixels outside the quad fail the edge tests
+
+	for (int y = y0; y <= y1; y++) {
+		float py = (float)y + 0.5f;
+		float* row = depths.data() + (size_t)(y * width);
+		int x = x0;
+
+#if OCCLUSION_USE_SSE
+		__m128 e0Row = _mm_set1_ps(edges[0].y * py + edges[0].z);
+		__m128 e1Row = _mm_set1_ps(edges[1].y * py + edges[1].z);
+		__m128 e2Row = _mm_set1_ps(edges[2].y * py + edges[2].z);
+		__m128 e3Row = _mm_set1_ps(edges[3].y * py + edges[3].z);
+		__m128 zRow = _mm_set1_ps(zdy * py + zk);
+		__m128 zero = _mm_setzero_ps();
+
+		for (; x <= x1; x += 4) {
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+
+			__m128 inside = _mm_cmpge_ps(_mm_add_ps(e0Row, _mm_mul_ps(_mm_set1_ps(edges[0].x), px)), zero);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(e1Row, _mm_mul_ps(_mm_set1_ps(edges[1].x), px)), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(e2Row, _mm_mul_ps(_mm_set1_ps(edges[2].x), px)), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(e3Row, _mm_mul_ps(_mm_set1_ps(edges[3].x), px)), zero));
+
+			__m128 z = _mm_add_ps(zRow, _mm_mul_ps(_mm_set1_ps(zdx), px));
+			__m128 old = _mm_loadu_ps(row + x);
+			__m128 nearer = _mm_max_ps(old, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+		}
+#endif
+
+		for (; x <= x1; x++) {
+			float px = (float)x + 0.5f;
+			bool inside = true;
+			for (const glm::vec3& e : edges) {
+				inside = inside && (e.x * px + e.y * py + e.z >= 0.f);
+			}
+
+			if (inside) {
+				row[x] = std::max(row[x], zdx * px + zdy * py + zk);
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+	glm::vec3 corners[8];
+	if (!projectCorners(min, max, corners)) {
+		return true;
+	}
+
+	glm::vec3 screenMin = corners[0], screenMax = corners[0];
+	for (const glm::vec3& c : corners) {
+		screenMin = glm::min(screenMin, c);
+		screenMax = glm::max(screenMax, c);
+	}
+
+	int x0 = std::max((int)std::floor(screenMin.x), 0);
+	int x1 = std::min((int)std::floor(screenMax.x), width - 1);
+	int y0 = std::max((int)std::floor(screenMin.y), 0);
+	int y1 = std::min((int)std::floor(screenMax.y), height - 1);
+
+	// off screen, that's for the frustum to decide
+	if (x0 > x1 || y0 > y1) {
+		return true;
+	}
+
+	// the box is hidden where an occluder is nearer than its nearest corner,
+	// with some slack so occluders don't hide themselves or boxes touching them
+	float nearest = screenMax.z * 1.001f;
+
+	for (int y = y0; y <= y1; y++) {
+		const float* row = depths.data() + (size_t)(y * width);
+		int x = x0;
+
+#if OCCLUSION_USE_SSE
+		__m128 boxDepth = _mm_set1_ps(nearest);
+		for (; x + 3 <= x1; x += 4) {
+			if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), boxDepth)) != 0) {
+				return true;
+			}
+		}
+#endif
+
+		for (; x <= x1; x++) {
+			if (row[x] <= nearest) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// ---------- Benchmark ----------
+
+void runOcclusionBenchmark(uint8_t renderDistance) {
+	int dist = std::max((int)renderDistance, 2);
+	const int frames = 100;
+
+	// the eye looks along +x at a hill of solid sections one chunk away, the window is behind it
+	glm::vec3 eye = glm::vec3(chunkSize.x * 0.5f, chunkSize.y * 0.5f, 40.f);
+	glm::mat4 viewProj = glm::perspective(glm::radians(70.f), 2.f, 0.1f, 1000.f) * glm::lookAt(eye, eye + glm::vec3(1, 0, -0.1f), glm::vec3(0, 0, 1));
+	Frustum frustum = Frustum::fromViewProjection(viewProj);
+
+	std::vector<std::pair<glm::vec3, glm::vec3>> occluders;
+	for (int y = -2; y <= 2; y++) {
+		glm::vec3 min = glm::vec3(chunkSize.x, y * chunkSize.y, 0) + extentsMin;
+		occluders.push_back({ min, min + glm::vec3(chunkSize.x, chunkSize.y, 4 * sectionHeight) });
+	}
+
+	std::vector<std::pair<glm::vec3, glm::vec3>> sections;
+	for (int x = -dist + 1; x < dist; x++) {
+		for (int y = -dist + 1; y < dist; y++) {
+			for (int s = 0; s < sectionCount; s++) {
+				glm::vec3 min = glm::vec3(x * chunkSize.x, y * chunkSize.y, s * sectionHeight) + extentsMin;
+				glm::vec3 max = min + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight);
+				if (frustum.isBoxVisible(min, max)) {
+					sections.push_back({ min, max });
+				}
+			}
+		}
+	}
+
+	OcclusionBuffer buffer;
+	size_t hidden = 0;
+	double tRaster = 0.0, tTest = 0.0;
+
+	for (int f = 0; f < frames; f++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		buffer.begin(viewProj);
+		for (const auto& [min, max] : occluders) {
+			buffer.addOccluder(min, max, eye);
+		}
+
+		auto rastered = std::chrono::high_resolution_clock::now();
+		hidden = 0;
+		for (const auto& [min, max] : sections) {
+			hidden += !buffer.isBoxVisible(min, max);
+		}
+
+		tRaster += std::chrono::duration<double, std::milli>(rastered - start).count();
+		tTest += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - rastered).count();
+	}
+
+	std::cout << "<=== Occlusion Benchmark (" << OcclusionBuffer::width << "x" << OcclusionBuffer::height << ", " << sections.size() << " sections in the frustum) ===>" << std::endl;
+	std::cout << "\tRasterize " << occluders.size() << " occluders : " << tRaster / frames << "ms" << std::endl;
+	std::cout << "\tTest sections : " << tTest / frames << "ms" << std::endl;
+	std::cout << "\tHidden sections : " << hidden << " / " << sections.size() << std::endl;
+	std::cout << std::endl;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A small CPU depth buffer. Boxes known to be solid are rasterized into it, and other boxes are
+// tested against it, so terrain hidden behind hills isn't drawn even though it's in the frustum.
+// Depths are stored as 1 / w, which interpolates linearly across the screen, nearer is larger.
+class OcclusionBuffer
+{
+public:
+	static constexpr int width = 256, height = 128;
+
+	OcclusionBuffer();
+
+	// Clears the buffer, boxes are projected with 'viewProj' until the next call
+	void begin(const glm::mat4& viewProj);
+
+	// Rasterizes the sides of the box that face 'eyePos', a box crossing the near plane is skipped
+	// @returns False if the box wasn't rasterized
+	bool addOccluder(const glm::vec3& min, const glm::vec3& max, const glm::vec3& eyePos);
+
+	// @returns False if an occluder is in front of the box at every pixel it could cover
+	bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+	// @returns 1 / w of the nearest occluder at the pixel, 0 if there is none
+	float getDepth(int x, int y) const {
+		return depths[(size_t)(y * width + x)];
+	}
+
+private:
+	// @returns False if a corner is behind the near plane, xy => pixels, z => 1 / w
+	bool projectCorners(const glm::vec3& min, const glm::vec3& max, glm::vec3* corners) const;
+	// Only writes pixels that lie entirely inside the quad, so an occluder never covers more than its silhouette
+	void rasterizeQuad(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d);
+
+	glm::mat4 viewProj = glm::mat4(1.f);
+	std::vector<float> depths = {}; // row major
+};
+
+// Culls a render window of sections behind a hill of solid sections and prints how long it takes
+void runOcclusionBenchmark(uint8_t renderDistance);
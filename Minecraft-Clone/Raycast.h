@@ -24,11 +24,14 @@ public:
 	static HitResult getHitResult(const glm::vec3& rayStart, const glm::vec3& rayDirection, float rayLength) {
 		float distanceTravelled = 0.f;
 
+		// one snapshot for the whole march, so it's safe from any thread
+		ChunkSnapshot chunks = ChunkManager::getInstance()->getSnapshot();
+
 		glm::ivec3 gridPos = glm::round(rayStart);
 
 		while (distanceTravelled < rayLength) {
 			gridPos = glm::round(rayStart + rayDirection * distanceTravelled);
-			if (ChunkManager::getInstance()->getBlockAtPos(gridPos) != AIR) {
+			if (chunks.getBlockAtPos(gridPos) != AIR) {
 				break;
 			}
 
@@ -50,6 +53,6 @@ public:
 			}
 		}
 
-		return { ChunkManager::getInstance()->getBlockAtPos(gridPos), gridPos, closestNormal };
+		return { chunks.getBlockAtPos(gridPos), gridPos, closestNormal };
 	}
 };
\ No newline at end of file
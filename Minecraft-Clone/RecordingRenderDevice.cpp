@@ -0,0 +1,226 @@
+#include "RecordingRenderDevice.h"
+#include <algorithm>
+
+void RecordingRenderDevice::resetStats() {
+	size_t liveBufferBytes = stats.liveBufferBytes;
+
+	stats = {};
+	stats.liveBufferBytes = liveBufferBytes;
+}
+
+// ---------- Buffers ----------
+
+GLuint RecordingRenderDevice::createBuffer(size_t bytes, const void* data, BufferUsage) {
+	GLuint buffer = nextHandle++;
+	allocateBuffer(buffer, bytes);
+
+	if (data != nullptr) {
+		stats.bytesUploaded += bytes;
+	}
+
+	return buffer;
+}
+
+uint8_t* RecordingRenderDevice::createMappedBuffer(size_t bytes, GLuint& buffer) {
+	buffer = nextHandle++;
+	allocateBuffer(buffer, bytes);
+
+	std::vector<uint8_t>& memory = mappedMemory[buffer];
+	memory.resize(bytes);
+	return memory.data();
+}
+
+void RecordingRenderDevice::deleteBuffer(GLuint buffer) {
+	auto itr = bufferSizes.find(buffer);
+	if (itr == bufferSizes.end()) {
+		stats.invalidCalls += (buffer != 0); // like GL, deleting 0 is fine
+		return;
+	}
+
+	liveBuffers--;
+	stats.liveBufferBytes -= itr->second;
+
+	bufferSizes.erase(itr);
+	mappedMemory.erase(buffer);
+}
+
+void RecordingRenderDevice::uploadBuffer(GLuint buffer, size_t offset, size_t bytes, const void*) {
+	if (checkRange(buffer, offset, bytes)) {
+		stats.bytesUploaded += bytes;
+	}
+}
+
+void RecordingRenderDevice::respecifyBuffer(GLuint buffer, size_t bytes, const void* data, BufferUsage) {
+	auto itr = bufferSizes.find(buffer);
+	if (itr == bufferSizes.end()) {
+		stats.invalidCalls++;
+		return;
+	}
+
+	stats.liveBufferBytes -= itr->second;
+	stats.liveBufferBytes += bytes;
+	itr->second = bytes;
+
+	stats.bufferAllocations++;
+	stats.bytesAllocated += bytes;
+	countStateChanges(); // binding it
+
+	if (data != nullptr) {
+		stats.bytesUploaded += bytes;
+	}
+}
+
+void RecordingRenderDevice::copyBuffer(GLuint source, size_t sourceOffset, GLuint dest, size_t destOffset, size_t bytes) {
+	if (checkRange(source, sourceOffset, bytes) && checkRange(dest, destOffset, bytes)) {
+		stats.bytesCopied += bytes;
+	}
+}
+
+bool RecordingRenderDevice::checkRange(GLuint buffer, size_t offset, size_t bytes) {
+	auto itr = bufferSizes.find(buffer);
+	if (itr == bufferSizes.end() || offset + bytes > itr->second) {
+		stats.invalidCalls++;
+		return false;
+	}
+
+	return true;
+}
+
+void RecordingRenderDevice::allocateBuffer(GLuint buffer, size_t bytes) {
+	bufferSizes[buffer] = bytes;
+
+	stats.bufferAllocations++;
+	stats.bytesAllocated += bytes;
+	liveBuffers++;
+	stats.liveBufferBytes += bytes;
+}
+
+// ---------- Vertex arrays ----------
+
+GLuint RecordingRenderDevice::createVertexArray() {
+	liveVertexArrays++;
+	return nextHandle++;
+}
+
+void RecordingRenderDevice::deleteVertexArray(GLuint vertexArray) {
+	liveVertexArrays -= (vertexArray != 0);
+}
+
+// ---------- Textures ----------
+
+GLuint RecordingRenderDevice::createTexture2D(int width, int height, const uint8_t*) {
+	stats.textureAllocations++;
+	stats.bytesUploaded += (size_t)(width * height * 3);
+
+	liveTextures++;
+	return nextHandle++;
+}
+
+GLuint RecordingRenderDevice::createTextureArray(int size, int, int) {
+	GLuint texture = nextHandle++;
+	textureSizes[texture] = size;
+
+	stats.textureAllocations++;
+	liveTextures++;
+	return texture;
+}
+
+void RecordingRenderDevice::uploadTextureLayer(GLuint texture, int level, int, int size, const uint8_t*) {
+	auto itr = textureSizes.find(texture);
+	if (itr == textureSizes.end() || size != std::max(itr->second >> level, 1)) {
+		stats.invalidCalls++;
+		return;
+	}
+
+	stats.bytesUploaded += (size_t)(size * size * 4);
+}
+
+void RecordingRenderDevice::deleteTexture(GLuint texture) {
+	textureSizes.erase(texture);
+	liveTextures -= (texture != 0);
+}
+
+// ---------- Shaders ----------
+
+GLuint RecordingRenderDevice::createProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+	// nothing to compile against, so only missing sources fail
+	if (vertexSource.empty() || fragmentSource.empty()) {
+		return 0;
+	}
+
+	livePrograms++;
+	return nextHandle++;
+}
+
+void RecordingRenderDevice::deleteProgram(GLuint program) {
+	livePrograms -= (program != 0);
+}
+
+void RecordingRenderDevice::setUniform(GLuint, const char*, const glm::mat4&) {}
+
+void RecordingRenderDevice::setUniform(GLuint, const char*, GLuint) {}
+
+// ---------- State and drawing ----------
+
+void RecordingRenderDevice::setViewport(int, int) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::setDepthTest(bool) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::setWireframe(bool) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::setBlending(bool) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::clear(const glm::vec4&) {
+	// a new frame, the GPU has caught up with the one before
+	signalledFence = nextFence - 1;
+}
+
+void RecordingRenderDevice::useProgram(GLuint) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::bindTextureArray(GLuint) {
+	countStateChanges();
+}
+
+void RecordingRenderDevice::bindStorageBuffer(GLuint, GLuint buffer) {
+	if (bufferSizes.find(buffer) == bufferSizes.end()) {
+		stats.invalidCalls++;
+	}
+
+	countStateChanges();
+}
+
+void RecordingRenderDevice::multiDrawIndirect(GLuint, GLuint indirectBuffer, size_t commandCount) {
+	// 4 uints per command
+	checkRange(indirectBuffer, 0, commandCount * 4 * sizeof(uint32_t));
+
+	countStateChanges(2); // vertex array, indirect buffer
+	stats.drawCalls++;
+	stats.drawCommands += commandCount;
+}
+
+// ---------- Sync ----------
+
+RenderDevice::Fence RecordingRenderDevice::insertFence() {
+	stats.fences++;
+	return (Fence)nextFence++;
+}
+
+bool RecordingRenderDevice::isFenceSignalled(Fence fence) {
+	return (uintptr_t)fence <= signalledFence;
+}
+
+void RecordingRenderDevice::deleteFence(Fence) {}
+
+void RecordingRenderDevice::finish() {
+	signalledFence = nextFence - 1;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <map>
+#include <vector>
+#include "RenderDevice.h"
+
+// What a RecordingRenderDevice has been asked to do, since the last resetStats()
+struct RenderDeviceStats {
+	size_t drawCalls = 0;
+	size_t drawCommands = 0;		// indirect commands across all draw calls
+	size_t stateChanges = 0;		// program, texture, buffer and vertex array binds, viewport and fixed-function state
+	size_t bufferAllocations = 0;	// created or re-specified buffers
+	size_t bytesAllocated = 0;		// by those allocations
+	size_t bytesUploaded = 0;		// CPU -> GPU, buffer data and texture layers
+	size_t bytesCopied = 0;			// GPU -> GPU buffer copies
+	size_t textureAllocations = 0;
+	size_t fences = 0;
+	size_t invalidCalls = 0;		// unknown handles or out of range writes, a real device would error or crash
+
+	size_t liveBufferBytes = 0;		// not reset, the size of the buffers currently allocated
+};
+
+// Renders nothing and just counts, so the render path can run (and be measured) without a GPU.
+// Live objects are counted by getObjectCounts(), like on any other device.
+// Mapped buffers are backed by real memory. Fences signal at the start of the next frame (clear()),
+// as if the GPU were one frame behind.
+class RecordingRenderDevice : public RenderDevice
+{
+public:
+	const RenderDeviceStats& getStats() const { return stats; }
+	void resetStats();
+
+	GLuint createBuffer(size_t bytes, const void* data, BufferUsage usage) override;
+	uint8_t* createMappedBuffer(size_t bytes, GLuint& buffer) override;
+	void deleteBuffer(GLuint buffer) override;
+	void uploadBuffer(GLuint buffer, size_t offset, size_t bytes, const void* data) override;
+	void respecifyBuffer(GLuint buffer, size_t bytes, const void* data, BufferUsage usage) override;
+	void copyBuffer(GLuint source, size_t sourceOffset, GLuint dest, size_t destOffset, size_t bytes) override;
+
+	GLuint createVertexArray() override;
+	void deleteVertexArray(GLuint vertexArray) override;
+
+	GLuint createTexture2D(int width, int height, const uint8_t* rgb) override;
+	GLuint createTextureArray(int size, int layers, int levels) override;
+	void uploadTextureLayer(GLuint texture, int level, int layer, int size, const uint8_t* rgba) override;
+	void deleteTexture(GLuint texture) override;
+
+	GLuint createProgram(const std::string& vertexSource, const std::string& fragmentSource) override;
+	void deleteProgram(GLuint program) override;
+	void setUniform(GLuint program, const char* name, const glm::mat4& value) override;
+	void setUniform(GLuint program, const char* name, GLuint value) override;
+
+	void setViewport(int width, int height) override;
+	void setDepthTest(bool enabled) override;
+	void setWireframe(bool enabled) override;
+	void setBlending(bool enabled) override;
+	void clear(const glm::vec4& color) override;
+	void useProgram(GLuint program) override;
+	void bindTextureArray(GLuint texture) override;
+	void bindStorageBuffer(GLuint index, GLuint buffer) override;
+	void multiDrawIndirect(GLuint vertexArray, GLuint indirectBuffer, size_t commandCount) override;
+
+	Fence insertFence() override;
+	bool isFenceSignalled(Fence fence) override;
+	void deleteFence(Fence fence) override;
+	void finish() override;
+
+private:
+	// @returns False (and counts an invalid call) if 'buffer' doesn't exist or is smaller than 'offset' + 'bytes'
+	bool checkRange(GLuint buffer, size_t offset, size_t bytes);
+
+	// in the stats since the last reset, and the devices' running total
+	void countStateChanges(size_t count = 1) {
+		stats.stateChanges += count;
+		stateChanges += count;
+	}
+	void allocateBuffer(GLuint buffer, size_t bytes);
+
+private:
+	RenderDeviceStats stats;
+	GLuint nextHandle = 1;
+
+	std::map<GLuint, size_t> bufferSizes = {};
+	std::map<GLuint, std::vector<uint8_t>> mappedMemory = {};
+	std::map<GLuint, int> textureSizes = {}; // only for texture arrays, to check uploads
+
+	uintptr_t nextFence = 1;
+	uintptr_t signalledFence = 0;
+};
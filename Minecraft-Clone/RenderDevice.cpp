@@ -0,0 +1,12 @@
+#include "RenderDevice.h"
+
+RenderDevice* RenderDevice::instance = nullptr;
+
+RenderObjectCounts RenderDevice::getObjectCounts() const {
+	RenderObjectCounts counts;
+	counts.buffers = liveBuffers;
+	counts.vertexArrays = liveVertexArrays;
+	counts.textures = liveTextures;
+	counts.programs = livePrograms;
+	return counts;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "glad/glad.h"
+
+enum class BufferUsage : uint8_t {
+	STATIC,		// written once
+	DYNAMIC,	// written now and then
+	STREAM		// re-written every frame
+};
+
+// Objects a device has created and not yet deleted
+struct RenderObjectCounts {
+	int buffers = 0;
+	int vertexArrays = 0;
+	int textures = 0;
+	int programs = 0;
+
+	int getTotal() const { return buffers + vertexArrays + textures + programs; }
+};
+
+// The rendering calls the game makes, so the render path can run against
+// OpenGL (GLRenderDevice) or without a GPU (RecordingRenderDevice).
+// Objects are plain handles, only meaningful to the device that made them.
+// Like GL itself, a device is only used by the thread that owns the context.
+class RenderDevice
+{
+public:
+	using Fence = void*;
+
+	static RenderDevice* getInstance() { return instance; }
+
+	// The device doesn't take ownership
+	static void setInstance(RenderDevice* device) { instance = device; }
+
+	virtual ~RenderDevice() = default;
+
+	// Safe from any thread, for the debug overlay
+	RenderObjectCounts getObjectCounts() const;
+
+	// @returns Binds and fixed-function state changes issued since the device was made, safe from any thread
+	size_t getStateChanges() const { return stateChanges; }
+
+	// Buffers
+	virtual GLuint createBuffer(size_t bytes, const void* data, BufferUsage usage) = 0;
+
+	// @returns Memory mapped into the buffer until it is deleted, writes to it need no flushing
+	virtual uint8_t* createMappedBuffer(size_t bytes, GLuint& buffer) = 0;
+	virtual void deleteBuffer(GLuint buffer) = 0;
+	virtual void uploadBuffer(GLuint buffer, size_t offset, size_t bytes, const void* data) = 0;
+
+	// Replaces the buffers' storage, orphaning the old one so the GPU can finish reading it
+	virtual void respecifyBuffer(GLuint buffer, size_t bytes, const void* data, BufferUsage usage) = 0;
+	virtual void copyBuffer(GLuint source, size_t sourceOffset, GLuint dest, size_t destOffset, size_t bytes) = 0;
+
+	// Vertex arrays, without attributes, shaders pull their vertex data from storage buffers
+	virtual GLuint createVertexArray() = 0;
+	virtual void deleteVertexArray(GLuint vertexArray) = 0;
+
+	// Textures, RGB(A)8 only
+	// @returns A texture with a full mip chain generated from 'rgb'
+	virtual GLuint createTexture2D(int width, int height, const uint8_t* rgb) = 0;
+	virtual GLuint createTextureArray(int size, int layers, int levels) = 0;
+	virtual void uploadTextureLayer(GLuint texture, int level, int layer, int size, const uint8_t* rgba) = 0;
+	virtual void deleteTexture(GLuint texture) = 0;
+
+	// Shaders
+	// @returns 0 if either shader doesn't compile
+	virtual GLuint createProgram(const std::string& vertexSource, const std::string& fragmentSource) = 0;
+	virtual void deleteProgram(GLuint program) = 0;
+	virtual void setUniform(GLuint program, const char* name, const glm::mat4& value) = 0;
+	virtual void setUniform(GLuint program, const char* name, GLuint value) = 0;
+
+	// State and drawing
+	virtual void setViewport(int width, int height) = 0;
+	virtual void setDepthTest(bool enabled) = 0;
+	virtual void setWireframe(bool enabled) = 0; // also turns back-face culling off
+	virtual void setBlending(bool enabled) = 0; // alpha blending, without depth writes so blended faces don't hide each other
+	virtual void clear(const glm::vec4& color) = 0;
+	virtual void useProgram(GLuint program) = 0;
+	virtual void bindTextureArray(GLuint texture) = 0;
+	virtual void bindStorageBuffer(GLuint index, GLuint buffer) = 0;
+
+	// Draws 'commandCount' DrawArraysIndirectCommands read from 'indirectBuffer', as triangles
+	virtual void multiDrawIndirect(GLuint vertexArray, GLuint indirectBuffer, size_t commandCount) = 0;
+
+	// Sync
+	virtual Fence insertFence() = 0;
+	virtual bool isFenceSignalled(Fence fence) = 0;
+	virtual void deleteFence(Fence fence) = 0;
+	virtual void finish() = 0; // waits for every command so far
+
+protected:
+	// kept up to date by the implementations, creating and deleting objects
+	std::atomic<int> liveBuffers = 0, liveVertexArrays = 0, liveTextures = 0, livePrograms = 0;
+	std::atomic<size_t> stateChanges = 0;
+
+private:
+	static RenderDevice* instance;
+};
@@ -0,0 +1,85 @@
+#include "RenderPacket.h"
+
+// ---------- RenderCommandList ----------
+
+void RenderCommandList::record(std::function<void()> command) {
+	commands.push_back(std::move(command));
+}
+
+void RenderCommandList::append(RenderCommandList& other) {
+	for (auto& command : other.commands) {
+		commands.push_back(std::move(command));
+	}
+
+	other.commands.clear();
+}
+
+void RenderCommandList::execute() {
+	for (auto& command : commands) {
+		command();
+	}
+
+	commands.clear();
+}
+
+void RenderCommandList::clear() {
+	commands.clear();
+}
+
+// ---------- UiDrawData ----------
+
+UiDrawData::~UiDrawData() {
+	clear();
+}
+
+void UiDrawData::capture(const ImDrawData* source) {
+	clear();
+
+	if (source == nullptr || !source->Valid) {
+		return;
+	}
+
+	// clones only hold the output buffers, which AddDrawList()'s checks don't expect
+	for (ImDrawList* list : source->CmdLists) {
+		ImDrawList* copy = list->CloneOutput();
+		lists.push_back(copy);
+
+		drawData.CmdLists.push_back(copy);
+		drawData.CmdListsCount++;
+		drawData.TotalVtxCount += copy->VtxBuffer.Size;
+		drawData.TotalIdxCount += copy->IdxBuffer.Size;
+	}
+
+	drawData.Valid = true;
+	drawData.DisplayPos = source->DisplayPos;
+	drawData.DisplaySize = source->DisplaySize;
+	drawData.FramebufferScale = source->FramebufferScale;
+}
+
+void UiDrawData::clear() {
+	drawData.Clear();
+
+	for (ImDrawList* list : lists) {
+		IM_DELETE(list);
+	}
+
+	lists.clear();
+}
+
+ImDrawData* UiDrawData::getDrawData() {
+	return lists.empty() ? nullptr : &drawData;
+}
+
+// ---------- RenderPacket ----------
+
+void RenderPacket::clear() {
+	glCommands.clear();
+
+	meshBuffer = nullptr;
+	chunkCommands.clear();
+	chunkDrawData.clear();
+	translucentCommands.clear();
+	translucentDrawData.clear();
+
+	ui.clear();
+}
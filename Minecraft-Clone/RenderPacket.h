@@ -0,0 +1,76 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <imgui/imgui.h>
+
+#include "glad/glad.h"
+#include "FaceAllocator.h"
+
+class ChunkMeshBuffer;
+
+// GL work recorded on the simulation thread and run later, in order, on the render thread
+class RenderCommandList
+{
+public:
+	void record(std::function<void()> command);
+
+	// Moves 'other's commands onto the end of this list
+	void append(RenderCommandList& other);
+
+	// Runs every command, then clears the list
+	void execute();
+	void clear();
+
+	size_t size() const { return commands.size(); }
+
+private:
+	std::vector<std::function<void()>> commands = {};
+};
+
+// Copies of ImGui's draw lists, so the UI can be drawn while ImGui builds the next frame.
+// Captured and cleared on the simulation thread, which owns ImGui's allocations.
+class UiDrawData
+{
+public:
+	UiDrawData() = default;
+	~UiDrawData();
+
+	UiDrawData(const UiDrawData&) = delete;
+	UiDrawData& operator = (const UiDrawData&) = delete;
+
+	void capture(const ImDrawData* source);
+	void clear();
+
+	// @returns Nullptr if nothing was captured
+	ImDrawData* getDrawData();
+
+private:
+	ImDrawData drawData;
+	std::vector<ImDrawList*> lists = {};
+};
+
+// Everything the render thread needs to draw one frame. Once submitted nothing
+// in it is touched by the simulation thread, which moves on to the next frame.
+struct RenderPacket {
+	RenderCommandList glCommands; // uploads etc, run before anything is drawn
+
+	glm::mat4 view = glm::mat4(1.f), proj = glm::mat4(1.f);
+	int viewportWidth = 0, viewportHeight = 0;
+	bool wireframe = false;
+
+	// the visible chunk ranges, as indirect draws into the shared face buffer
+	ChunkMeshBuffer* meshBuffer = nullptr;
+	GLuint chunkProgram = 0, blockTextures = 0; // blockTextures is a GL_TEXTURE_2D_ARRAY
+	std::vector<DrawArraysIndirectCommand> chunkCommands = {};
+	std::vector<glm::vec4> chunkDrawData = {};
+
+	// translucent sections, back to front and drawn blended after everything opaque
+	std::vector<DrawArraysIndirectCommand> translucentCommands = {};
+	std::vector<glm::vec4> translucentDrawData = {};
+
+	UiDrawData ui;
+
+	void clear();
+};
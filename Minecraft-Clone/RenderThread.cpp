@@ -0,0 +1,147 @@
+#include "RenderThread.h"
+#include "ChunkMeshBuffer.h"
+#include "RenderDevice.h"
+#include <chrono>
+#include <imgui/imgui_impl_opengl3.h>
+
+RenderThread::RenderThread(GLFWwindow* _window) : window(_window) {
+	glfwMakeContextCurrent(nullptr);
+	thread = std::thread(&RenderThread::threadFunc, this);
+}
+
+RenderThread::~RenderThread() {
+	{
+		std::lock_guard<std::mutex> lock(packetMutex);
+		shouldRun = false;
+	}
+
+	packetQueued.notify_all();
+	thread.join();
+
+	glfwMakeContextCurrent(window);
+}
+
+RenderPacket& RenderThread::beginPacket() {
+	auto t_start = std::chrono::high_resolution_clock::now();
+	int index = 0;
+	{
+		std::unique_lock<std::mutex> lock(packetMutex);
+
+		index = recordingPacket;
+		packetDrawn.wait(lock, [&]() { return !packetInUse[index]; });
+		packetInUse[index] = true;
+
+		std::chrono::duration<float, std::milli> t_wait = std::chrono::high_resolution_clock::now() - t_start;
+		stats.simulationWaitMs = t_wait.count();
+	}
+
+	// nothing else touches a packet that isn't in use
+	packets[index].clear();
+	return packets[index];
+}
+
+void RenderThread::submitPacket() {
+	{
+		std::lock_guard<std::mutex> lock(packetMutex);
+
+		queuedPackets.push(recordingPacket);
+		recordingPacket = (recordingPacket + 1) % (int)packets.size();
+	}
+
+	packetQueued.notify_one();
+}
+
+RenderThreadStats RenderThread::getStats() {
+	std::lock_guard<std::mutex> lock(packetMutex);
+
+	return stats;
+}
+
+void RenderThread::threadFunc() {
+	glfwMakeContextCurrent(window);
+
+	while (true) {
+		auto t_waitStart = std::chrono::high_resolution_clock::now();
+		int index = 0;
+		{
+			std::unique_lock<std::mutex> lock(packetMutex);
+
+			// packets submitted before shutdown are still drawn, they may hold uploads and GL object releases
+			packetQueued.wait(lock, [&]() { return !queuedPackets.empty() || !shouldRun; });
+			if (!shouldRun && queuedPackets.empty()) {
+				break;
+			}
+
+			index = queuedPackets.front();
+			queuedPackets.pop();
+		}
+
+		size_t stateChangesBefore = RenderDevice::getInstance()->getStateChanges();
+		auto t_drawStart = std::chrono::high_resolution_clock::now();
+		drawPacket(packets[index]);
+		auto t_drawEnd = std::chrono::high_resolution_clock::now();
+		size_t stateChanges = RenderDevice::getInstance()->getStateChanges() - stateChangesBefore;
+
+		{
+			std::lock_guard<std::mutex> lock(packetMutex);
+
+			packetInUse[index] = false;
+
+			std::chrono::duration<float, std::milli> t_wait = t_drawStart - t_waitStart;
+			std::chrono::duration<float, std::milli> t_draw = t_drawEnd - t_drawStart;
+			stats.renderWaitMs = t_wait.count();
+			stats.renderMs = t_draw.count();
+			stats.stateChanges = stateChanges;
+		}
+
+		packetDrawn.notify_one();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::drawPacket(RenderPacket& packet) {
+	RenderDevice* device = RenderDevice::getInstance();
+
+	// uploads first, the draws below may use them
+	packet.glCommands.execute();
+
+	if (packet.viewportWidth > 0 && (packet.viewportWidth != viewportWidth || packet.viewportHeight != viewportHeight)) {
+		viewportWidth = packet.viewportWidth;
+		viewportHeight = packet.viewportHeight;
+		device->setViewport(viewportWidth, viewportHeight);
+	}
+
+	if (!stateApplied || packet.wireframe != wireframe) {
+		wireframe = packet.wireframe;
+		stateApplied = true;
+		device->setWireframe(wireframe);
+	}
+
+	device->clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	if (packet.meshBuffer != nullptr && (!packet.chunkCommands.empty() || !packet.translucentCommands.empty())) {
+		device->useProgram(packet.chunkProgram);
+		device->setUniform(packet.chunkProgram, "view", packet.view);
+		device->setUniform(packet.chunkProgram, "proj", packet.proj);
+
+		device->bindTextureArray(packet.blockTextures);
+		packet.meshBuffer->draw(packet.chunkCommands, packet.chunkDrawData);
+
+		// over the opaque faces, which they are depth tested against
+		if (!packet.translucentCommands.empty()) {
+			device->setBlending(true);
+			packet.meshBuffer->draw(packet.translucentCommands, packet.translucentDrawData);
+			device->setBlending(false);
+		}
+
+		device->bindTextureArray(0);
+	}
+
+	if (ImDrawData* ui = packet.ui.getDrawData()) {
+		ImGui_ImplOpenGL3_RenderDrawData(ui);
+	}
+
+	glfwSwapBuffers(window);
+}
+
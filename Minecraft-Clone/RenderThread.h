@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "RenderPacket.h"
+
+struct RenderThreadStats {
+	float renderMs = 0.f;			// drawing the last packet, including the buffer swap
+	float renderWaitMs = 0.f;		// render thread idle, waiting for the simulation to submit a packet
+	float simulationWaitMs = 0.f;	// simulation thread blocked in beginPacket(), waiting for the render thread
+	size_t stateChanges = 0;		// issued through the RenderDevice drawing the last packet, not counting ImGui's
+};
+
+// Owns the GL context, and with it the RenderDevice, and draws the packets the simulation (main) thread records.
+// The simulation can record one frame ahead, while the previous one is drawn.
+class RenderThread
+{
+public:
+	// Takes the GL context from the calling thread
+	RenderThread(GLFWwindow* window);
+
+	// Stops after the current packet and gives the GL context back to the calling thread
+	~RenderThread();
+
+	// @returns An empty packet to record the next frame into, waits while both packets are in use
+	RenderPacket& beginPacket();
+
+	// Queues the packet from beginPacket() to be drawn
+	void submitPacket();
+
+	RenderThreadStats getStats();
+
+private:
+	void threadFunc();
+	void drawPacket(RenderPacket& packet);
+
+private:
+	GLFWwindow* window = nullptr;
+	std::thread thread;
+
+	std::mutex packetMutex;
+	std::condition_variable packetQueued, packetDrawn;
+	std::array<RenderPacket, 2> packets;
+	std::array<bool, 2> packetInUse = {}; // recording, queued or being drawn
+	std::queue<int> queuedPackets = {};
+	int recordingPacket = 0;
+	bool shouldRun = true;
+	RenderThreadStats stats;
+
+	// render thread only
+	int viewportWidth = 0, viewportHeight = 0;
+	bool wireframe = false, stateApplied = false;
+};
@@ -0,0 +1,134 @@
+#include "SectionVisibility.h"
+#include <deque>
+
+// ---------- SectionVisibility ----------
+
+SectionVisibility SectionVisibility::allConnected() {
+	SectionVisibility v;
+	v.bits = ((uint64_t)1 << (FACE_COUNT * FACE_COUNT)) - 1;
+	return v;
+}
+
+SectionVisibility SectionVisibility::compute(const std::bitset<visibilitySectionVolume>& opaque) {
+	const int n = visibilitySectionSize;
+
+	// walling off one face from another takes at least a full layer of blocks
+	if (opaque.count() < (size_t)(n * n)) {
+		return allConnected();
+	}
+
+	SectionVisibility v;
+	std::bitset<visibilitySectionVolume> visited = opaque;
+	std::vector<uint16_t> stack = {};
+
+	for (int start = 0; start < visibilitySectionVolume; start++) {
+		if (visited[start]) {
+			continue;
+		}
+
+		// flood fill one pocket of air, noting which faces it touches
+		uint8_t touched = 0;
+		visited[start] = true;
+		stack.push_back((uint16_t)start);
+
+		while (!stack.empty()) {
+			int i = stack.back();
+			stack.pop_back();
+
+			int x = i % n, y = (i / n) % n, z = i / (n * n);
+
+			if (y == 0) touched |= 1 << FRONT;
+			if (y == n - 1) touched |= 1 << BACK;
+			if (x == 0) touched |= 1 << LEFT;
+			if (x == n - 1) touched |= 1 << RIGHT;
+			if (z == n - 1) touched |= 1 << TOP;
+			if (z == 0) touched |= 1 << BOTTOM;
+
+			auto visit = [&](bool inside, int neighbour) {
+				if (inside && !visited[neighbour]) {
+					visited[neighbour] = true;
+					stack.push_back((uint16_t)neighbour);
+				}
+			};
+
+			visit(x > 0, i - 1);
+			visit(x < n - 1, i + 1);
+			visit(y > 0, i - n);
+			visit(y < n - 1, i + n);
+			visit(z > 0, i - n * n);
+			visit(z < n - 1, i + n * n);
+		}
+
+		for (int a = 0; a < FACE_COUNT; a++) {
+			for (int b = a + 1; b < FACE_COUNT; b++) {
+				if ((touched >> a & 1) && (touched >> b & 1)) {
+					v.connect((BlockFace)a, (BlockFace)b);
+				}
+			}
+		}
+	}
+
+	return v;
+}
+
+// ---------- SectionGraph ----------
+
+void SectionGraph::reset(const glm::ivec3& gridSize) {
+	size = gridSize;
+	sections.assign((size_t)(size.x * size.y * size.z), SectionVisibility::allConnected());
+}
+
+void SectionGraph::setSection(const glm::ivec3& cell, const SectionVisibility& visibility) {
+	sections[cellToIndex(cell)] = visibility;
+}
+
+bool SectionGraph::isInGrid(const glm::ivec3& cell) const {
+	return glm::all(glm::greaterThanEqual(cell, glm::ivec3(0))) && glm::all(glm::lessThan(cell, size));
+}
+
+size_t SectionGraph::findVisible(const glm::ivec3& start, const std::function<bool(const glm::ivec3&)>& isInView, std::vector<uint8_t>& visible) const {
+	visible.assign(sections.size(), 0);
+	if (!isInGrid(start)) {
+		return 0;
+	}
+
+	struct Step {
+		glm::ivec3 cell;
+		int entryFace;		// FACE_COUNT for the start section, it can see out of every face
+		uint8_t travelled;	// directions taken to get here
+	};
+
+	std::deque<Step> queue = {};
+	queue.push_back({ start, FACE_COUNT, 0 });
+	visible[cellToIndex(start)] = 1;
+	size_t visibleCount = 1;
+
+	while (!queue.empty()) {
+		Step step = queue.front();
+		queue.pop_front();
+
+		const SectionVisibility& section = sections[cellToIndex(step.cell)];
+
+		for (int d = 0; d < FACE_COUNT; d++) {
+			// going back the way we came can't reveal anything new
+			if (step.travelled & (1 << inverseFace[d])) {
+				continue;
+			}
+
+			if (step.entryFace != FACE_COUNT && !section.isConnected((BlockFace)step.entryFace, (BlockFace)d)) {
+				continue;
+			}
+
+			glm::ivec3 next = step.cell + faceNormals[d];
+			if (!isInGrid(next) || visible[cellToIndex(next)] || !isInView(next)) {
+				continue;
+			}
+
+			visible[cellToIndex(next)] = 1;
+			visibleCount++;
+			queue.push_back({ next, inverseFace[d], (uint8_t)(step.travelled | (1 << d)) });
+		}
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BlockAttribs.h"
+
+// sections are cubes of this many blocks
+constexpr int visibilitySectionSize = 16;
+constexpr int visibilitySectionVolume = visibilitySectionSize * visibilitySectionSize * visibilitySectionSize;
+
+// Which of a sections' six faces can see each other through non-opaque blocks.
+// Faces use the BlockFace directions, so TOP is the sections' +z side.
+class SectionVisibility
+{
+public:
+	// @returns A section where every face sees every other, like an empty one
+	static SectionVisibility allConnected();
+
+	// Flood fills the non-opaque blocks, 'opaque' is indexed x + y * size + z * size^2
+	static SectionVisibility compute(const std::bitset<visibilitySectionVolume>& opaque);
+
+	bool isConnected(BlockFace a, BlockFace b) const {
+		return (bits >> (a * FACE_COUNT + b)) & 1;
+	}
+
+	void connect(BlockFace a, BlockFace b) {
+		bits |= (uint64_t)1 << (a * FACE_COUNT + b);
+		bits |= (uint64_t)1 << (b * FACE_COUNT + a);
+	}
+
+private:
+	uint64_t bits = 0; // 6x6 symmetric matrix
+};
+
+// A box of sections that is searched outwards from the camera, a section
+// is only potentially visible if a path of connected faces leads to it.
+class SectionGraph
+{
+public:
+	// Resizes the grid, every section starts out all connected
+	void reset(const glm::ivec3& gridSize);
+	void setSection(const glm::ivec3& cell, const SectionVisibility& visibility);
+
+	bool isInGrid(const glm::ivec3& cell) const;
+
+	// Breadth first search from 'start', never stepping back against a direction already taken.
+	// Sections 'isInView' rejects are not entered. Sets visible[cell] to 1 for every section reached.
+	// @returns The number of sections reached
+	size_t findVisible(const glm::ivec3& start, const std::function<bool(const glm::ivec3&)>& isInView, std::vector<uint8_t>& visible) const;
+
+	size_t cellToIndex(const glm::ivec3& cell) const {
+		return (size_t)(cell.x + size.x * (cell.y + size.y * cell.z));
+	}
+
+private:
+	glm::ivec3 size = { 0, 0, 0 };
+	std::vector<SectionVisibility> sections = {};
+};
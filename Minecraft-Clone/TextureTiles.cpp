@@ -0,0 +1,86 @@
+#include "TextureTiles.h"
+#include <algorithm>
+#include <thread>
+
+int getMipLevelCount(int size) {
+	int levels = 1;
+	while (size > 1) {
+		size /= 2;
+		levels++;
+	}
+
+	return levels;
+}
+
+// @returns The level below 'src', each pixel the average of the 2x2 pixels above it
+static std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, int srcSize) {
+	int size = std::max(srcSize / 2, 1);
+	std::vector<uint8_t> dst((size_t)(size * size * 4));
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			for (int c = 0; c < 4; c++) {
+				int sum = 0;
+				for (int sy = 0; sy < 2; sy++) {
+					for (int sx = 0; sx < 2; sx++) {
+						int px = std::min(x * 2 + sx, srcSize - 1);
+						int py = std::min(y * 2 + sy, srcSize - 1);
+						sum += src[(size_t)((py * srcSize + px) * 4 + c)];
+					}
+				}
+
+				dst[(size_t)((y * size + x) * 4 + c)] = (uint8_t)((sum + 2) / 4);
+			}
+		}
+	}
+
+	return dst;
+}
+
+static void buildTile(const uint8_t* image, int width, int tileSize, int tileX, int tileY, TextureTile& out) {
+	out.size = tileSize;
+	out.levels.resize((size_t)getMipLevelCount(tileSize));
+
+	std::vector<uint8_t>& top = out.levels[0];
+	top.resize((size_t)(tileSize * tileSize * 4));
+	for (int y = 0; y < tileSize; y++) {
+		const uint8_t* row = image + ((size_t)(tileY * tileSize + y) * width + (size_t)tileX * tileSize) * 4;
+		std::copy(row, row + tileSize * 4, top.begin() + (size_t)y * tileSize * 4);
+	}
+
+	int size = tileSize;
+	for (size_t level = 1; level < out.levels.size(); level++) {
+		out.levels[level] = downsample(out.levels[level - 1], size);
+		size = std::max(size / 2, 1);
+	}
+}
+
+std::vector<TextureTile> buildTextureTiles(const uint8_t* image, int width, int height, int tileSize) {
+	if (image == nullptr || tileSize <= 0) {
+		return {};
+	}
+
+	int tilesX = width / tileSize;
+	int tilesY = height / tileSize;
+	std::vector<TextureTile> tiles((size_t)(tilesX * tilesY));
+	if (tiles.empty()) {
+		return tiles;
+	}
+
+	// tiles are independent, each worker takes every n'th one
+	int workerCount = (int)std::clamp(std::thread::hardware_concurrency(), 1u, (unsigned int)tiles.size());
+	std::vector<std::thread> workers;
+	for (int w = 0; w < workerCount; w++) {
+		workers.emplace_back([&, w]() {
+			for (int t = w; t < (int)tiles.size(); t += workerCount) {
+				buildTile(image, width, tileSize, t % tilesX, t / tilesX, tiles[(size_t)t]);
+			}
+		});
+	}
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	return tiles;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// One square tile of an image with its own mip chain, RGBA8.
+// Level i is (size >> i) pixels square, down to 1x1.
+struct TextureTile {
+	int size = 0;
+	std::vector<std::vector<uint8_t>> levels = {};
+};
+
+// @returns The number of mip levels a tile of 'size' pixels has, including the full size one
+int getMipLevelCount(int size);
+
+// Cuts an RGBA8 image into square tiles of 'tileSize' pixels (row by row, left to right)
+// and builds each tiles' mip chain from its own pixels, so neighbouring tiles never bleed
+// into each other. Tiles are split between worker threads.
+std::vector<TextureTile> buildTextureTiles(const uint8_t* image, int width, int height, int tileSize);
@@ -0,0 +1,100 @@
+#include "TranslucentSort.h"
+#include "Chunk.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+glm::ivec3 getTranslucentSortCell(const glm::vec3& eyePos, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+	glm::ivec3 cell = glm::floor(eyePos - boxMin);
+	glm::ivec3 cellCount = glm::round(boxMax - boxMin);
+
+	return glm::clamp(cell, glm::ivec3(-1), cellCount);
+}
+
+void sortFacesBackToFront(FaceData* faces, uint32_t faceCount, const glm::vec3& eyePos, uint8_t lod) {
+	const float scale = (float)(1 << lod);
+
+	// keyed once up front, the comparisons only touch floats
+	thread_local std::vector<std::pair<float, FaceData>> keyed = {};
+	keyed.resize(faceCount);
+
+	for (uint32_t i = 0; i < faceCount; i++) {
+		// blocks are centered on their index, a cell of 'scale' blocks between its first and last
+		glm::vec3 cellCenter = glm::vec3(faces[i].getPosition()) * scale + (scale - 1.f) * 0.5f;
+		glm::vec3 faceCenter = cellCenter + glm::vec3(faceNormals[faces[i].getDirection()]) * (scale * 0.5f);
+
+		glm::vec3 toEye = eyePos - faceCenter;
+		keyed[i] = { glm::dot(toEye, toEye), faces[i] };
+	}
+
+	std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	for (uint32_t i = 0; i < faceCount; i++) {
+		faces[i] = keyed[i].second;
+	}
+}
+
+void sortDrawsBackToFront(std::vector<TranslucentDraw>& draws) {
+	std::sort(draws.begin(), draws.end(), [](const TranslucentDraw& a, const TranslucentDraw& b) { return a.distance > b.distance; });
+}
+
+void runTranslucentSortBenchmark(uint8_t renderDistance) {
+	int dist = std::max((int)renderDistance, 1);
+	int chunks = (2 * dist - 1) * (2 * dist - 1);
+
+	// every section holds a pane of glass across its middle, seen from both sides
+	std::vector<FaceData> pane;
+	for (int x = 0; x < (int)chunkSize.x; x++) {
+		for (int y = 0; y < (int)chunkSize.y; y++) {
+			for (BlockFace face : { TOP, BOTTOM }) {
+				FaceData f;
+				f.setPosition({ x, y, sectionHeight / 2 });
+				f.setBlockTexId(GLASS, face);
+				f.setDirection(face);
+				pane.push_back(f);
+			}
+		}
+	}
+
+	// the eye steps one block, only the sections it moves across need their faces re-sorted
+	glm::vec3 eye = glm::vec3(chunkSize.x, chunkSize.y, 0) * 0.5f + glm::vec3(0, 0, 70.3f);
+	glm::vec3 nextEye = eye + glm::vec3(1, 0, 0);
+	size_t crossedSections = 0;
+
+	std::vector<TranslucentDraw> draws;
+	for (int x = -dist + 1; x < dist; x++) {
+		for (int y = -dist + 1; y < dist; y++) {
+			for (int s = 0; s < sectionCount; s++) {
+				glm::vec3 sectionMin = glm::vec3(x, y, 0) * chunkSize + extentsMin + glm::vec3(0, 0, s * sectionHeight);
+				glm::vec3 sectionMax = sectionMin + glm::vec3(chunkSize.x, chunkSize.y, sectionHeight);
+				crossedSections += getTranslucentSortCell(eye, sectionMin, sectionMax) != getTranslucentSortCell(nextEye, sectionMin, sectionMax);
+
+				glm::vec3 toEye = eye - (sectionMin + sectionMax) * 0.5f;
+				draws.push_back({ { { 0, (uint32_t)pane.size() }, (uint32_t)pane.size(), { x, y }, 0 }, glm::dot(toEye, toEye) });
+			}
+		}
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	sortDrawsBackToFront(draws);
+	std::chrono::duration<double, std::milli> tSections = std::chrono::high_resolution_clock::now() - start;
+
+	// the worst case, every section re-sorted in the same frame
+	std::vector<FaceData> faces;
+	double tFaces = 0.0;
+	for (const TranslucentDraw& d : draws) {
+		faces = pane;
+		glm::vec3 chunkStart = glm::vec3(d.draw.chunkIndex, 0) * chunkSize;
+
+		start = std::chrono::high_resolution_clock::now();
+		sortFacesBackToFront(faces.data(), (uint32_t)faces.size(), eye - chunkStart, 0);
+		tFaces += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	std::cout << "<=== Translucent Sort Benchmark (" << chunks << " chunks, " << draws.size() << " sections) ===>" << std::endl;
+	std::cout << "\tSections back to front : " << tSections.count() << "ms" << std::endl;
+	std::cout << "\tFaces, every section (" << pane.size() * draws.size() << " faces) : " << tFaces << "ms" << std::endl;
+	std::cout << "\tFaces, after a 1 block step (" << crossedSections << " sections) : ~"
+		<< tFaces * (double)crossedSections / (double)draws.size() << "ms" << std::endl;
+	std::cout << std::endl;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "FaceAllocator.h"
+
+struct FaceData;
+
+// A translucent section to draw, 'distance' is squared from the eye to its center
+struct TranslucentDraw {
+	ChunkDraw draw;
+	float distance = 0.f;
+};
+
+// Never returned by getTranslucentSortCell, marks faces that haven't been sorted yet
+const glm::ivec3 unsortedCell = glm::ivec3(INT_MIN);
+
+// @returns The block the eye is in relative to the box, clamped to one block past its sides.
+// Faces only swap order when the eye crosses one of their planes, which all lie inside the box,
+// so the faces need re-sorting when this changes and not while the eye moves around outside.
+glm::ivec3 getTranslucentSortCell(const glm::vec3& eyePos, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+// Sorts faces furthest first from 'eyePos', which is relative to the chunk, like the faces' positions
+void sortFacesBackToFront(FaceData* faces, uint32_t faceCount, const glm::vec3& eyePos, uint8_t lod);
+
+// Sorts furthest first, so nearer translucent sections blend over the ones behind them
+void sortDrawsBackToFront(std::vector<TranslucentDraw>& draws);
+
+// Sorts a render window of sections full of translucent faces and prints how long it takes
+void runTranslucentSortBenchmark(uint8_t renderDistance);
@@ -0,0 +1,116 @@
+#include "UploadRing.h"
+
+// ---------- UploadRing ----------
+
+UploadRing::UploadRing(size_t ringCapacity) : capacity(ringCapacity) {}
+
+uint8_t* UploadRing::allocate(size_t size, RegionId& id, size_t& offset) {
+	std::lock_guard<std::mutex> lock(ringMutex);
+
+	if (size == 0 || size > capacity) {
+		return nullptr;
+	}
+
+	// regions are contiguous, so one that doesn't fit before the end starts over at 0
+	size_t start = head;
+	size_t padding = 0;
+	if (start + size > capacity) {
+		padding = capacity - start;
+		start = 0;
+	}
+
+	if (used + padding + size > capacity) {
+		return nullptr;
+	}
+
+	// the skipped end is freed along with the regions around it
+	if (padding > 0) {
+		regions.push_back({ head, padding, true, 0 });
+	}
+
+	id = firstRegion + regions.size();
+	offset = start;
+	regions.push_back({ start, size, false, 0 });
+
+	head = start + size;
+	used += padding + size;
+
+	return getMemory() + start;
+}
+
+void UploadRing::release(RegionId id) {
+	std::lock_guard<std::mutex> lock(ringMutex);
+
+	regions[(size_t)(id - firstRegion)].released = true;
+}
+
+void UploadRing::submit() {
+	std::lock_guard<std::mutex> lock(ringMutex);
+
+	Fence fence = nullptr;
+	for (Region& r : regions) {
+		if (!r.released || r.batch != 0) {
+			continue;
+		}
+
+		// one fence covers everything released since the last submit
+		if (fence == nullptr) {
+			fence = insertFence();
+			batches.push_back({ nextBatch, fence });
+		}
+
+		r.batch = nextBatch;
+	}
+
+	if (fence != nullptr) {
+		nextBatch++;
+	}
+}
+
+void UploadRing::reclaim() {
+	std::lock_guard<std::mutex> lock(ringMutex);
+
+	while (!batches.empty() && isFenceSignalled(batches.front().fence)) {
+		completedBatch = batches.front().id;
+		deleteFence(batches.front().fence);
+		batches.pop_front();
+	}
+
+	// regions free in order, one still in use holds back everything after it
+	while (!regions.empty()) {
+		const Region& r = regions.front();
+		if (!r.released || r.batch == 0 || r.batch > completedBatch) {
+			break;
+		}
+
+		used -= r.size;
+		regions.pop_front();
+		firstRegion++;
+	}
+}
+
+size_t UploadRing::getUsed() {
+	std::lock_guard<std::mutex> lock(ringMutex);
+
+	return used;
+}
+
+// ---------- CpuUploadRing ----------
+
+CpuUploadRing::CpuUploadRing(size_t ringCapacity) : UploadRing(ringCapacity), memory(ringCapacity) {}
+
+void CpuUploadRing::signalFences() {
+	signalledFence = nextFence - 1;
+}
+
+uint8_t* CpuUploadRing::getMemory() {
+	return memory.data();
+}
+
+UploadRing::Fence CpuUploadRing::insertFence() {
+	return (Fence)nextFence++;
+}
+
+bool CpuUploadRing::isFenceSignalled(Fence fence) {
+	return (uintptr_t)fence <= signalledFence;
+}
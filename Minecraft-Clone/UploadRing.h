@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Staging memory for uploads, handed out front to back and wrapping around.
+// A region comes back once it has been released and the fence submitted after
+// its release has signalled, i.e. once the GPU has finished reading it.
+// Any thread may allocate, the rest is for the thread that owns the fences.
+class UploadRing
+{
+public:
+	using RegionId = uint64_t;
+
+	UploadRing(size_t ringCapacity);
+	virtual ~UploadRing() = default;
+
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator = (const UploadRing&) = delete;
+
+	// @returns Where to write 'size' bytes, or nullptr if the ring is full until older regions are reclaimed
+	uint8_t* allocate(size_t size, RegionId& id, size_t& offset);
+
+	// Call once the region has been copied from (or won't be)
+	void release(RegionId id);
+
+	// Fences every region released since the last submit, call after issuing their copies
+	void submit();
+
+	// Frees the regions whose fences have signalled
+	void reclaim();
+
+	size_t getCapacity() const { return capacity; }
+	size_t getUsed();
+
+protected:
+	using Fence = void*;
+
+	virtual uint8_t* getMemory() = 0;
+	virtual Fence insertFence() = 0;
+	virtual bool isFenceSignalled(Fence fence) = 0;
+	virtual void deleteFence(Fence fence) = 0;
+
+private:
+	struct Region {
+		size_t offset = 0;
+		size_t size = 0;
+		bool released = false;
+		uint64_t batch = 0; // 0 until submitted
+	};
+
+	struct Batch {
+		uint64_t id = 0;
+		Fence fence = nullptr;
+	};
+
+	std::mutex ringMutex;
+	size_t capacity = 0;
+	size_t head = 0; // where the next region starts
+	size_t used = 0;
+
+	std::deque<Region> regions = {};
+	RegionId firstRegion = 0; // id of regions.front()
+
+	std::deque<Batch> batches = {};
+	uint64_t nextBatch = 1;
+	uint64_t completedBatch = 0;
+};
+
+// Plain memory and manually signalled fences, for using the ring without a GPU
+class CpuUploadRing : public UploadRing
+{
+public:
+	CpuUploadRing(size_t ringCapacity);
+
+	// Signals every fence inserted so far, like the GPU catching up
+	void signalFences();
+
+protected:
+	uint8_t* getMemory() override;
+	Fence insertFence() override;
+	bool isFenceSignalled(Fence fence) override;
+	void deleteFence(Fence) override {}
+
+private:
+	std::vector<uint8_t> memory = {};
+	uintptr_t nextFence = 1;
+	uintptr_t signalledFence = 0;
+};
@@ -7,7 +7,9 @@ class WorldGenerator
 public:
 	static BlockType getBlockTypeAtPos(glm::vec3& pos);
 
-private:
+	// @returns The height of the top block of the column, without generating it
 	static GLuint getSurfaceHeightAtPos(glm::vec3& pos);
+
+private:
 	static GLuint genRandomValFromPos(glm::vec3& pos, GLuint range);
 };
@@ -3,18 +3,18 @@
 in vec2 Texcoord;
 in float DistanceFromCamera;
 flat in uint TextureId;
+in float Shade; // corner AO and light level
 
 out vec4 fragColor;
 
-uniform sampler2D tex;
+uniform sampler2DArray tex; // one layer per block texture
 uniform uint renderDist;
 
 void main() {
    float maxDistance = max((renderDist * 16.0) - 8.0, 8.0); // full fade will be at this distance
    float fadeFactor = clamp(DistanceFromCamera / maxDistance, 0.0, 1.0);
 
-   vec2 uvOffset = vec2(TextureId % 4u, TextureId / 4u) * 0.25f;
-   vec4 texColor = texture(tex, Texcoord + uvOffset);
+   vec4 texColor = texture(tex, vec3(Texcoord, float(TextureId)));
    vec3 fadeColor = vec3(0, 0, 0);
-   fragColor = vec4(mix(texColor.rgb, fadeColor, fadeFactor), texColor.a);
+   fragColor = vec4(mix(texColor.rgb * Shade, fadeColor, fadeFactor), texColor.a);
 }
\ No newline at end of file
@@ -1,22 +1,35 @@
-#version 330 core
+#version 460 core
 
-// Vertex data
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec2 texcoord;
+// Quad corners, indirect draws aren't indexed so it holds both triangles
+const vec2 quadCorners[6] = vec2[6](
+   vec2(-0.5, -0.5), vec2( 0.5, -0.5), vec2( 0.5,  0.5),
+   vec2( 0.5,  0.5), vec2(-0.5,  0.5), vec2(-0.5, -0.5)
+);
 
-// Face data
-layout (location = 2) in uint blockPos;
-layout (location = 3) in uint directionId;
+// Which of the faces' 4 corners each quad corner is, for per-corner AO
+const uint quadCornerIds[6] = uint[6](0u, 1u, 2u, 2u, 3u, 0u);
 
 out vec2 Texcoord;
 out float DistanceFromCamera;
 flat out uint TextureId;
+out float Shade;
 
 uniform mat4 view;
 uniform mat4 proj;
-uniform vec2 chunkIndex;
 
-vec3 getRotatedPos(uint direction) {
+// Per-draw data, one entry per indirect draw command
+// xy => chunk index, z => block scale (2^lod, LOD faces are positioned in cells of that many blocks)
+layout (std430, binding = 0) readonly buffer DrawData {
+   vec4 drawData[];
+};
+
+// Face data, one per instance, offset by each draws' base instance
+// Packed as in FaceFormat.h, the getFace*() decoders are inserted with the #version line
+layout (std430, binding = 1) readonly buffer Faces {
+   uvec2 faces[];
+};
+
+vec3 getRotatedPos(vec3 position, uint direction) {
    switch (direction) {
       case 0u: return vec3( position.x, -position.z, position.y);
       case 1u: return vec3(-position.x,  position.z, position.y);
@@ -39,14 +52,27 @@ vec3 getFaceOffset(uint direction) {
 }
 
 void main() {
-   uint iDirection = (directionId >> 4) & 15u;
-   vec3 vBlockPos = vec3((blockPos >> 12) & 15u, (blockPos >> 8) & 15u, blockPos & 255u);
+   vec2 chunkIndex = drawData[gl_DrawID].xy;
+   float scale = drawData[gl_DrawID].z;
+
+   uvec2 face = faces[gl_BaseInstance + gl_InstanceID];
+   uint iDirection = getFaceDirection(face);
+   uint ao = (getFaceAO(face) >> (quadCornerIds[gl_VertexID] * 2u)) & FACE_MAX_AO;
+
+   vec2 corner = quadCorners[gl_VertexID];
+   vec3 position = vec3(corner, 0.0);
+   vec2 texcoord = vec2(corner.x + 0.5, 0.5 - corner.y);
+   vec3 vBlockPos = vec3(getFacePosX(face), getFacePosY(face), getFacePosZ(face));
+
+   // a cell of 'scale' blocks is centered between its first and last block
+   vec3 cellCenter = vBlockPos * scale + (scale - 1.0) * 0.5;
 
-   vec3 offsetPos = getRotatedPos(iDirection) + vBlockPos + getFaceOffset(iDirection) + vec3(chunkIndex * vec2(16.f, 16.f), 0);
+   vec3 offsetPos = (getRotatedPos(position, iDirection) + getFaceOffset(iDirection)) * scale + cellCenter + vec3(chunkIndex * vec2(16.f, 16.f), 0);
    vec4 viewPos = view * vec4(offsetPos, 1.0);
    gl_Position = proj * viewPos;
 
-   Texcoord = texcoord / 4.f; // remap from 0-1 to 0-0.25
+   Texcoord = texcoord * scale; // tiles repeat, so LOD faces keep one tile per block
    DistanceFromCamera = length(viewPos.xyz);
-   TextureId = directionId & 15u;
+   TextureId = getFaceTexture(face);
+   Shade = (1.0 - 0.2 * float(ao)) * float(getFaceLight(face)) / float(FACE_MAX_LIGHT);
 }
\ No newline at end of file
@@ -24,8 +24,17 @@
 #include "DebugClock.h"
 #include "Raycast.h"
 #include "Config.h"
+#include "FrameScheduler.h"
+#include "LodMesher.h"
+#include "TranslucentSort.h"
+#include "OcclusionBuffer.h"
+#include "DeviceUploadRing.h"
+#include "GLRenderDevice.h"
+#include "RenderThread.h"
+#include "FramePacer.h"
 
 int WINDOW_WIDTH = 0, WINDOW_HEIGHT = 0;
+int framebufferWidth = 0, framebufferHeight = 0;
 Camera cam = Camera({ chunkSize.x / 2, chunkSize.y / 2, 12 }, { 1, 1, 0 });
 glm::vec2 camChunkIndex = Chunk::posToChunkIndex(cam.getPosition());
 GLuint renderingMode = 0;
@@ -33,6 +42,24 @@ GLuint numRenderingModes = 2; // normal, wire-frame
 GLuint renderDistance = 0;
 BlockType currentBlockType = DIRT;
 bool drawImGui = false;
+bool useRingStorage = false;
+bool benchmarkChunkStorage = false;
+bool caveCulling = false;
+bool frontToBackChunks = false;
+bool estimateOverdraw = false;
+bool occlusionCulling = false;
+bool benchmarkOcclusion = false;
+bool benchmarkLod = false;
+bool benchmarkTranslucentSort = false;
+int lodDistance = 0;
+int farTerrainScale = 0;
+int uploadBudgetKb = -1;
+int stagingRingKb = 0;
+int prefetchMs = 0;
+int chunkCacheKb = 0;
+int flythroughSeconds = 0;
+int flythroughSpeed = 0;
+FrameMode frameMode = FRAME_CAPPED;
 
 void setupConfig();
 void processInput(GLFWwindow* window);
@@ -53,10 +80,10 @@ int main(void)
     if (!glfwInit())
         return -1;
 
-    // Tell GLFW that we are going to use OpenGL version 3.3
+    // Tell GLFW that we are going to use OpenGL version 4.6 (for multi-draw indirect and gl_DrawID)
     // and that we are using modern OpenGL ('core profile')
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     /* Create a windowed mode window and its OpenGL context */
@@ -82,39 +109,76 @@ int main(void)
         return -1;
     }
 
+    RenderDevice::setInstance(new GLRenderDevice());
+    RenderDevice* device = RenderDevice::getInstance();
+
     AssetManager::loadShader("generic", "./assets/generic.vert", "./assets/generic.frag");
     AssetManager::loadShader("line", "./assets/line.vert", "./assets/line.frag");
     GLuint shaderProgram = AssetManager::getAssetHandle("generic");
 
     // Bind shader uniforms
     // Set up projection
-    GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(cam.getView()));
+    device->setUniform(shaderProgram, "view", cam.getView());
+
+    // the far terrain pushes the fade (and the far plane, past the corners of its square) out
+    GLuint fadeDistance = renderDistance * (GLuint)std::max(farTerrainScale, 1);
+    float farPlane = std::max(1000.0f, fadeDistance * chunkSize.x * 1.5f);
 
-    glm::mat4 proj = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 1000.0f);
-    GLint projLoc = glGetUniformLocation(shaderProgram, "proj");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(proj));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, farPlane);
+    device->setUniform(shaderProgram, "proj", proj);
 
-    GLint renderDistLoc = glGetUniformLocation(shaderProgram, "renderDist");
-    glUniform1ui(renderDistLoc, renderDistance);
+    device->setUniform(shaderProgram, "renderDist", fadeDistance);
 
-    glEnable(GL_DEPTH_TEST);
+    device->setDepthTest(true);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     setRenderingMode(0); // set to default rendering mode
 
     DebugClock::setEnabled(false);
     DebugClock::recordTime("Chunk gen start");
 
-    ChunkManager::getInstance()->initChunks((uint8_t)renderDistance);
+    if (benchmarkChunkStorage) {
+        ChunkStorage::runBenchmark((uint8_t)renderDistance);
+    }
+
+    if (benchmarkLod) {
+        runLodBenchmark((uint8_t)renderDistance);
+    }
+
+    if (benchmarkTranslucentSort) {
+        runTranslucentSortBenchmark((uint8_t)renderDistance);
+    }
+
+    if (benchmarkOcclusion) {
+        runOcclusionBenchmark((uint8_t)renderDistance);
+    }
+
+    ChunkManager::getInstance()->setUploadBudget(uploadBudgetKb);
+    ChunkManager::getInstance()->setStagingRing(stagingRingKb);
+    ChunkManager::getInstance()->setPrefetchTime(prefetchMs);
+    ChunkManager::getInstance()->setCaveCulling(caveCulling);
+    ChunkManager::getInstance()->setFrontToBack(frontToBackChunks);
+    ChunkManager::getInstance()->setOverdrawEstimate(estimateOverdraw && drawImGui);
+    ChunkManager::getInstance()->setOcclusionCulling(occlusionCulling);
+    ChunkManager::getInstance()->setLodDistance(std::max(lodDistance, 0));
+    ChunkManager::getInstance()->setFarTerrainDistance((int)renderDistance * std::max(farTerrainScale, 0));
+    ChunkManager::getInstance()->setCacheBudget((size_t)std::max(chunkCacheKb, 0));
+    ChunkManager::getInstance()->initChunks((uint8_t)renderDistance, useRingStorage);
 
     DebugClock::recordTime("Chunk gen end");
     DebugClock::printTimePoints();
 
-    AssetManager::loadTexture("./assets/texture-atlas.png");
+    // one array layer per 16px block texture
+    AssetManager::loadTextureArray("./assets/texture-atlas.png", 16);
 
     const int targetFPS = 60;
-    const double frameDuration = 1.0 / targetFPS;
+
+    FrameScheduler scheduler(targetFPS);
+    FramePacer pacer(targetFPS, frameMode);
+
+    // the render thread swaps buffers, but the interval belongs to the context so is set while this thread has it
+    glfwSwapInterval(frameMode == FRAME_VSYNC ? 1 : 0);
 
     auto t_previous = std::chrono::high_resolution_clock::now();
 
@@ -125,14 +189,28 @@ int main(void)
     ImGui::StyleColorsDark();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+    ImGui_ImplOpenGL3_NewFrame(); // creates ImGui's GL objects while this thread still has the context
+
+    // from here on only the render thread touches GL, this thread records packets for it
+    RenderThread* renderThread = new RenderThread(window);
+    float simulationMs = 0.f;
 
     float minFPS = FLT_MAX;
     float maxFPS = FLT_MIN;
 
+    // scripted fly-through, counts how many chunks are missing each frame
+    float flythroughTime = 0.f;
+    size_t flythroughFrames = 0, missingChunkFrames = 0, maxMissingChunks = 0;
+    if (flythroughSeconds > 0) {
+        cam.moveSpeed = (float)flythroughSpeed;
+    }
+
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window))
     {
         auto t_frameStart = std::chrono::high_resolution_clock::now();
+        scheduler.beginFrame();
+        pacer.beginFrame();
 
         // Calculate delta time from previous frame
         std::chrono::duration<float> t_deltaTime = t_frameStart - t_previous;
@@ -140,25 +218,54 @@ int main(void)
 
         float deltaSeconds = t_deltaTime.count();
         processInput(window);
-        if (cam.update(deltaSeconds)) {
-            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(cam.getView()));
 
+        bool isFlyingThrough = flythroughTime < (float)flythroughSeconds;
+        if (isFlyingThrough) {
+            cam.addMoveInput({ 0, 1, 0 });
+            flythroughTime += deltaSeconds;
+        }
+
+        if (cam.update(deltaSeconds)) {
             reloadChunks();
         }
 
-        ChunkManager::getInstance()->checkForLoadedChunks();
-        ChunkManager::getInstance()->updateChunks();
+        ChunkManager::getInstance()->prefetchChunks(cam.getPosition(), cam.getVelocity());
+
+        // deferred work shares what's left of the frame, the rest carries over
+        scheduler.run(GL_UPLOADS, [](float budgetMs) { ChunkManager::getInstance()->checkForLoadedChunks(budgetMs); });
+        scheduler.run(CHUNK_UPDATES, [](float budgetMs) { ChunkManager::getInstance()->updateChunks(budgetMs); });
+        scheduler.run(MESH_SWAPS, [](float budgetMs) { ChunkManager::getInstance()->swapMeshes(budgetMs); });
+        scheduler.run(GARBAGE_COLLECTION, [](float budgetMs) { ChunkManager::getInstance()->collectGarbage(budgetMs); });
+        scheduler.run(FAR_TERRAIN, [](float budgetMs) { ChunkManager::getInstance()->updateFarTerrain(budgetMs); });
+
+        size_t missingChunks = ChunkManager::getInstance()->getMissingChunkCount();
+        if (isFlyingThrough) {
+            flythroughFrames++;
+            missingChunkFrames += missingChunks;
+            maxMissingChunks = std::max(maxMissingChunks, missingChunks);
+
+            if (flythroughTime >= (float)flythroughSeconds) {
+                std::cout << "<=== Fly-through (" << flythroughSpeed << " blocks/s, prefetch " << prefetchMs << "ms) ===>" << std::endl;
+                std::cout << "\tFrames : " << flythroughFrames << std::endl;
+                std::cout << "\tMissing chunk-frames : " << missingChunkFrames << std::endl;
+                std::cout << "\tMax missing : " << maxMissingChunks << std::endl << std::endl;
+            }
+        }
 
         /* Render here */
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // waits if the render thread is still behind on the frame before last
+        RenderPacket& packet = renderThread->beginPacket();
+        packet.view = cam.getView();
+        packet.proj = proj;
+        packet.viewportWidth = framebufferWidth;
+        packet.viewportHeight = framebufferHeight;
+        packet.wireframe = (renderingMode == 1);
 
         // Tell ImGui we are working with a new frame
-        ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        ChunkManager::getInstance()->renderChunks();
+        ChunkManager::getInstance()->renderChunks(proj * cam.getView(), cam.getPosition(), packet);
 
         float currentFPS = io.Framerate;
         if (currentFPS < minFPS) minFPS = currentFPS;
@@ -181,6 +288,43 @@ int main(void)
             ImGui::Begin("Graphic Info.");
             ImGui::Text("Faces: %i", faceCount);
             ImGui::Text("Face Data: %.2f kb", (sizeof(FaceData) * faceCount) / 1'024.f);
+            ChunkMeshBufferStats meshStats = ChunkManager::getInstance()->getMeshBufferStats();
+            ImGui::Text("Face Buffer: %.1f / %.1f kb (%i free blocks)", meshStats.usedBytes / 1'024.f, meshStats.capacityBytes / 1'024.f, (int)meshStats.freeBlocks);
+            if (DeviceUploadRing* ring = ChunkManager::getInstance()->getUploadRing()) {
+                ImGui::Text("Staging Ring: %.1f / %.1f kb", ring->getUsed() / 1'024.f, ring->getCapacity() / 1'024.f);
+            }
+            DrawStats drawStats = ChunkManager::getInstance()->getDrawStats();
+            ImGui::Text("Draw Calls: %i (%i commands)", (int)drawStats.drawCalls, (int)drawStats.drawCommands);
+            ImGui::Text("Culled Chunks: %i / %i", (int)drawStats.culledChunks, (int)drawStats.chunks);
+            ImGui::Text("Culled Sections: %i / %i (%i occluded)", (int)drawStats.culledSections, (int)drawStats.sections, (int)drawStats.occludedSections);
+            ImGui::Text("Hidden By Terrain: %i chunks, %i sections (%i occluders, %.3f ms)", (int)drawStats.hiddenChunks, (int)drawStats.hiddenSections, (int)drawStats.occluders, drawStats.occlusionMs);
+            ImGui::Text("Back-Facing Faces: %i", (int)drawStats.backFacingFaces);
+            ImGui::Text("LOD Chunks: %i", (int)drawStats.lodChunks);
+            FarTerrainStats farStats = ChunkManager::getInstance()->getFarTerrainStats();
+            ImGui::Text("Far Terrain: %i / %i tiles drawn (%i dirty), %i faces", (int)drawStats.farTiles, (int)farStats.tiles, (int)farStats.dirtyTiles, (int)farStats.faces);
+            ImGui::Text("Far Terrain Memory: %.1f kb faces, %.1f kb for %i edited chunks", farStats.faceBytes / 1'024.f, farStats.summaryBytes / 1'024.f, (int)farStats.summaries);
+            ImGui::Text("Far Terrain Meshing: %.3f ms (%.1f ms total)", farStats.lastUpdateMs, farStats.totalMs);
+            if (estimateOverdraw) {
+                ImGui::Text("Draw Order: %i moves, est. overdraw %.2fx", (int)drawStats.reorderedChunks, drawStats.coveredTiles > 0 ? (float)drawStats.shadedTiles / (float)drawStats.coveredTiles : 0.f);
+            } else {
+                ImGui::Text("Draw Order: %i moves", (int)drawStats.reorderedChunks);
+            }
+            ImGui::Text("Translucent Sections: %i (%i re-sorted, %i faces, %.3f ms)", (int)drawStats.translucentSections, (int)drawStats.sortedSections, (int)drawStats.sortedFaces, drawStats.translucentSortMs);
+            ImGui::Text("State Changes: %i", (int)renderThread->getStats().stateChanges);
+            RenderObjectCounts objects = device->getObjectCounts();
+            ImGui::Text("GL Objects: %i (%i buffers, %i vertex arrays, %i textures, %i programs)", objects.getTotal(), objects.buffers, objects.vertexArrays, objects.textures, objects.programs);
+            ImGui::Text("Pending Uploads: %i", (int)ChunkManager::getInstance()->getPendingUploadCount());
+
+            ImGui::Text("Missing Chunks: %i", (int)missingChunks);
+            ImGui::Text("Prefetched: %i ready, %i used", (int)ChunkManager::getInstance()->getPrefetchedCount(), (int)ChunkManager::getInstance()->getPrefetchHits());
+
+            ChunkPoolStats poolStats = ChunkManager::getInstance()->getPoolStats();
+            ImGui::Text("Chunk Pool: %i hits / %i misses (%.1f%%)", (int)poolStats.hits, (int)poolStats.misses, poolStats.getHitRate() * 100.f);
+            ImGui::Text("Pooled Chunks: %i", (int)poolStats.pooled);
+
+            ChunkCacheStats cacheStats = ChunkManager::getInstance()->getCacheStats();
+            ImGui::Text("Chunk Cache: %i chunks, %.1f / %.1f kb", (int)cacheStats.entries, cacheStats.usedBytes / 1'024.f, cacheStats.budgetBytes / 1'024.f);
+            ImGui::Text("Cache Hits: %i (%i evicted)", (int)cacheStats.hits, (int)cacheStats.evictions);
             ImGui::End();
 
             ImGui::SetNextWindowSize(ImVec2(0, 0)); // set next window to auto-fit its' content
@@ -188,37 +332,69 @@ int main(void)
             ImGui::Begin("Block Info.");
             ImGui::Text("Placable Block: %s", BlockNames[currentBlockType + 1].data());
             ImGui::End();
+
+            ImGui::SetNextWindowSize(ImVec2(0, 0)); // set next window to auto-fit its' content
+            ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH - 50.f, 150), 0, ImVec2(1, 0));
+            ImGui::Begin("Frame Budget");
+            ImGui::Text("Deferred Work: %.2fms", scheduler.getTotalBudgetMs());
+            for (uint8_t i = 0; i < FRAME_TASK_COUNT; i++) {
+                FrameTask task = (FrameTask)i;
+                ImGui::Text("%s: %.2f / %.2fms", frameTaskNames[task].data(), scheduler.getUsedMs(task), scheduler.getBudgetMs(task));
+            }
+            ImGui::End();
+
+            RenderThreadStats threadStats = renderThread->getStats();
+            ImGui::SetNextWindowSize(ImVec2(0, 0)); // set next window to auto-fit its' content
+            ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH - 50.f, 300), 0, ImVec2(1, 0));
+            ImGui::Begin("Threads");
+            ImGui::Text("Simulation: %.2fms (waited %.2fms)", simulationMs, threadStats.simulationWaitMs);
+            ImGui::Text("Render: %.2fms (waited %.2fms)", threadStats.renderMs, threadStats.renderWaitMs);
+            ImGui::Text("Serial: %.2fms, Overlapped: %.2fms", simulationMs + threadStats.renderMs, std::max(simulationMs, threadStats.renderMs));
+            ImGui::End();
+
+            FramePacerStats pacerStats = pacer.getStats();
+            ImGui::SetNextWindowSize(ImVec2(0, 0)); // set next window to auto-fit its' content
+            ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH - 50.f, 400), 0, ImVec2(1, 0));
+            ImGui::Begin("Frame Pacing");
+            ImGui::Text("Mode: %s", frameModeNames[pacer.getMode()].data());
+            ImGui::Text("Frame Time: %.2f +/- %.2fms (%.2f-%.2fms)", pacerStats.meanMs, pacerStats.stdDevMs, pacerStats.minMs, pacerStats.maxMs);
+            ImGui::Text("Waiting: %.2fms slept, %.2fms spun", pacerStats.sleptMs, pacerStats.spunMs);
+            ImGui::End();
         }
 
-        // Draw ImGui window/s here
+        // Hand the frame over to the render thread, which draws it while the next one is simulated
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+        packet.ui.capture(ImGui::GetDrawData());
+        renderThread->submitPacket();
 
         /* Poll for and process events */
         glfwPollEvents();
 
+        scheduler.endFrame();
+
         // Calculate the time taken to render & poll events
         auto t_frameEnd = std::chrono::high_resolution_clock::now();
 
         std::chrono::duration<float> t_frameTime = t_frameEnd - t_frameStart;
+        simulationMs = t_frameTime.count() * 1'000.f - renderThread->getStats().simulationWaitMs;
 
         // Wait the rest of the frame to reach target FPS
-        while (t_frameTime.count() < frameDuration) {
-            t_frameEnd = std::chrono::high_resolution_clock::now();
-            t_frameTime = t_frameEnd - t_frameStart;
-        }
+        pacer.endFrame();
     }
 
+    delete renderThread; // gives the GL context back to this thread
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     delete ChunkManager::getInstance();
 
-    glDeleteProgram(shaderProgram);
+    device->deleteProgram(shaderProgram);
+
+    // last, the chunk manager frees its buffers through it
+    RenderDevice::setInstance(nullptr);
+    delete device;
 
     glfwTerminate();
     return 0;
@@ -233,6 +409,28 @@ void setupConfig() {
     WINDOW_HEIGHT = Config::getVar<int>("height");
 
     drawImGui = Config::getVar<bool>("drawImGui");
+    useRingStorage = Config::getVar<bool>("useRingStorage");
+    benchmarkChunkStorage = Config::getVar<bool>("benchmarkChunkStorage");
+    caveCulling = Config::getVar<bool>("caveCulling");
+    frontToBackChunks = Config::getVar<bool>("frontToBackChunks");
+    estimateOverdraw = Config::getVar<bool>("estimateOverdraw");
+    occlusionCulling = Config::getVar<bool>("occlusionCulling");
+    benchmarkLod = Config::getVar<bool>("benchmarkLod");
+    benchmarkTranslucentSort = Config::getVar<bool>("benchmarkTranslucentSort");
+    benchmarkOcclusion = Config::getVar<bool>("benchmarkOcclusion");
+    lodDistance = Config::getVar<int>("lodDistance");
+    farTerrainScale = Config::getVar<int>("farTerrainScale");
+
+    uploadBudgetKb = Config::getVar<int>("uploadBudgetKb");
+    stagingRingKb = Config::getVar<int>("stagingRingKb");
+    prefetchMs = Config::getVar<int>("prefetchMs");
+    chunkCacheKb = Config::getVar<int>("chunkCacheKb");
+
+    flythroughSeconds = Config::getVar<int>("flythroughSeconds");
+    flythroughSpeed = Config::getVar<int>("flythroughSpeed");
+
+    int frameModeVar = Config::getVar<int>("frameMode");
+    frameMode = (frameModeVar > 0 && frameModeVar < FRAME_MODE_COUNT ? (FrameMode)frameModeVar : FRAME_CAPPED);
 }
 
 void processInput(GLFWwindow* window) {
@@ -291,8 +489,9 @@ void processInput(GLFWwindow* window) {
 
 #pragma warning(suppress: 4100)
 void frameBufferSizeCallback(GLFWwindow* window, int width, int height) {
-    // tell OpenGL that the new rendering area is at position (0, 0) and extents (width, height)
-    glViewport(0, 0, width, height);
+    // the render thread resizes the rendering area to (width, height) with the next packet
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 bool firstMouse = true;
@@ -339,22 +538,8 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 }
 
 void setRenderingMode(GLuint newMode) {
+    // applied by the render thread, 1 is wire-frame
     renderingMode = newMode % numRenderingModes;
-
-    switch (renderingMode) {
-        case 0: {
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
-
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        } break;
-
-        case 1: {
-            glDisable(GL_CULL_FACE);
-
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        } break;
-    }
 }
 
 void reloadChunks() {
@@ -364,32 +549,9 @@ void reloadChunks() {
         return;
     }
 
-    // any chunk outside render distance should:
-    // -> be cleared of data (faces, blocks, etc.)
-    // -> re-loaded at new position
-    std::vector<glm::vec2> newIndexes = {};
-
-    ChunkManager* chunkManager = ChunkManager::getInstance();
-    for (int i = (int)chunkManager->chunkCount() - 1; i >= 0; i--) {
-        auto& pair = chunkManager->at(i);
-
-        if (pair.second != nullptr) {
-            glm::vec2 curChunkIndex = pair.second->getChunkIndex();
-            float distX = glm::distance(chunkIndex.x, curChunkIndex.x);
-            float distY = glm::distance(chunkIndex.y, curChunkIndex.y);
-
-            if (distX >= renderDistance || distY >= renderDistance) {
-                chunkManager->removeChunk(curChunkIndex);
-                newIndexes.emplace_back(chunkIndex - (curChunkIndex - camChunkIndex));
-            }
-        }
-    }
-
-    for (glm::vec2& index : newIndexes) {
-        chunkManager->addChunk(index);
-    }
-
-    newIndexes.clear();
+    // any chunk outside render distance is unloaded,
+    // and any index that came into render distance is loaded
+    ChunkManager::getInstance()->moveRenderWindow(chunkIndex);
 
     camChunkIndex = chunkIndex;
 }
@@ -0,0 +1,146 @@
+#include "Test.h"
+#include "FaceAllocator.h"
+
+#include <random>
+
+TEST(FaceAllocator, AllocatesTheSmallestBlockThatFits) {
+	FaceAllocator allocator(1'000);
+
+	// free blocks of 100 at 0, 50 at 200, 300 at 400 and 200 at the end
+	FaceRange a, b, c, d, e, f;
+	CHECK(allocator.allocate(100, a));
+	CHECK(allocator.allocate(100, b));
+	CHECK(allocator.allocate(50, c));
+	CHECK(allocator.allocate(150, d));
+	CHECK(allocator.allocate(300, e));
+	CHECK(allocator.allocate(100, f));
+	allocator.free(a);
+	allocator.free(c);
+	allocator.free(e);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)4);
+
+	// an exact fit, then the smallest block that's bigger, the big blocks stay whole
+	FaceRange exact, smaller;
+	CHECK(allocator.allocate(50, exact));
+	CHECK_EQ(exact.offset, c.offset);
+	CHECK(allocator.allocate(80, smaller));
+	CHECK_EQ(smaller.offset, a.offset);
+	CHECK_EQ(allocator.getLargestFreeBlock(), 300u);
+
+	FaceRange tooBig;
+	CHECK(!allocator.allocate(301, tooBig));
+	CHECK_EQ(allocator.getUsed(), 1'000u - 20u - 300u - 200u);
+}
+
+TEST(FaceAllocator, FreedBlocksMergeWithTheirNeighbours) {
+	FaceAllocator allocator(300);
+
+	FaceRange a, b, c;
+	CHECK(allocator.allocate(100, a));
+	CHECK(allocator.allocate(100, b));
+	CHECK(allocator.allocate(100, c));
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)0);
+
+	// the block after, then the one before, then both at once
+	allocator.free(c);
+	allocator.free(b);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)1);
+	CHECK_EQ(allocator.getLargestFreeBlock(), 200u);
+
+	CHECK(allocator.allocate(100, b));
+	CHECK(allocator.allocate(100, c));
+	allocator.free(a);
+	allocator.free(c);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)2);
+	allocator.free(b);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)1);
+	CHECK_EQ(allocator.getLargestFreeBlock(), 300u);
+	CHECK_EQ(allocator.getUsed(), 0u);
+}
+
+TEST(FaceAllocator, GrowingMergesWithAFreeTail) {
+	FaceAllocator allocator(100);
+
+	FaceRange a, b;
+	CHECK(allocator.allocate(60, a));
+	CHECK(!allocator.allocate(60, b));
+
+	allocator.grow(200);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)1);
+	CHECK_EQ(allocator.getLargestFreeBlock(), 140u);
+	CHECK(allocator.allocate(60, b));
+	CHECK_EQ(b.offset, 60u);
+	CHECK_EQ(a.offset, 0u);
+}
+
+TEST(FaceAllocator, RandomChurnNeverOverlapsAndFreesBackToOneBlock) {
+	const uint32_t capacity = 4'096;
+	FaceAllocator allocator(capacity);
+	std::mt19937 rng(7);
+
+	std::vector<FaceRange> live;
+	std::vector<int> owner(capacity, -1);
+
+	for (int step = 0; step < 20'000; step++) {
+		if (!live.empty() && (rng() % 2 == 0 || allocator.getLargestFreeBlock() < 64)) {
+			size_t i = rng() % live.size();
+			for (uint32_t s = live[i].offset; s < live[i].offset + live[i].size; s++) {
+				owner[s] = -1;
+			}
+
+			allocator.free(live[i]);
+			live[i] = live.back();
+			live.pop_back();
+			continue;
+		}
+
+		FaceRange r;
+		if (!allocator.allocate(1 + rng() % 64, r)) {
+			continue;
+		}
+
+		bool overlaps = false;
+		for (uint32_t s = r.offset; s < r.offset + r.size; s++) {
+			overlaps = overlaps || s >= capacity || owner[s] != -1;
+			if (s < capacity) {
+				owner[s] = step;
+			}
+		}
+
+		CHECK(!overlaps);
+		live.push_back(r);
+	}
+
+	for (const FaceRange& r : live) {
+		allocator.free(r);
+	}
+
+	CHECK_EQ(allocator.getUsed(), 0u);
+	CHECK_EQ(allocator.getFreeBlockCount(), (size_t)1);
+	CHECK_EQ(allocator.getLargestFreeBlock(), capacity);
+}
+
+TEST(FaceAllocator, DrawCommandsDrawEachChunksFaces) {
+	std::vector<ChunkDraw> draws = {
+		{ { 0, 64 }, 10, { 1, 2 }, 0 },
+		{ { 64, 64 }, 0, { 3, 4 }, 0 },		// nothing to draw
+		{ { 128, 64 }, 100, { 5, 6 }, 2 },	// more faces than its range holds
+	};
+
+	std::vector<DrawArraysIndirectCommand> commands;
+	std::vector<glm::vec4> drawData;
+	buildDrawCommands(draws, commands, drawData);
+
+	CHECK_EQ(commands.size(), (size_t)2);
+	CHECK_EQ(drawData.size(), commands.size());
+	if (commands.size() != 2) {
+		return;
+	}
+
+	// one quad instanced per face, starting at the chunks' range
+	CHECK(commands[0].count == 6 && commands[0].instanceCount == 10 && commands[0].first == 0 && commands[0].baseInstance == 0);
+	CHECK(commands[1].count == 6 && commands[1].instanceCount == 64 && commands[1].baseInstance == 128);
+	// LOD chunks draw their cells 2^lod blocks wide
+	CHECK(drawData[0] == glm::vec4(1, 2, 1, 0));
+	CHECK(drawData[1] == glm::vec4(5, 6, 4, 0));
+}
@@ -0,0 +1,106 @@
+#include "Test.h"
+#include "Chunk.h"
+#include "FaceFormat.h"
+
+#include <iterator>
+#include <random>
+#include <string>
+
+TEST(FaceFormat, FieldsFitTheirWordsWithoutOverlapping) {
+	uint32_t usedBits[faceWordCount] = {};
+	for (const FaceField& field : faceFields) {
+		CHECK(field.word < faceWordCount);
+		CHECK(field.shift + field.bits <= 32);
+
+		uint32_t bits = field.mask() << field.shift;
+		CHECK_EQ(usedBits[field.word] & bits, 0u);
+		usedBits[field.word] |= bits;
+	}
+
+	CHECK_EQ(sizeof(FaceData), faceWordCount * sizeof(uint32_t));
+}
+
+TEST(FaceFormat, EveryFieldRoundTrips) {
+	std::mt19937 rng(13);
+
+	for (int i = 0; i < 1'000; i++) {
+		uint32_t words[faceWordCount] = {};
+		uint32_t values[std::size(faceFields)] = {};
+
+		for (size_t f = 0; f < std::size(faceFields); f++) {
+			values[f] = rng() & faceFields[f].mask();
+			packFaceField(words, faceFields[f], values[f]);
+		}
+
+		// packing a field leaves the others alone
+		for (size_t f = 0; f < std::size(faceFields); f++) {
+			CHECK_EQ(unpackFaceField(words, faceFields[f]), values[f]);
+		}
+	}
+
+	// the extremes, and values too wide are truncated
+	for (const FaceField& field : faceFields) {
+		uint32_t words[faceWordCount] = { ~0u, ~0u };
+		packFaceField(words, field, 0);
+		CHECK_EQ(unpackFaceField(words, field), 0u);
+
+		packFaceField(words, field, field.mask());
+		CHECK_EQ(unpackFaceField(words, field), field.mask());
+		CHECK_EQ(words[0] & words[1], ~0u);
+
+		packFaceField(words, field, field.mask() + 1);
+		CHECK_EQ(unpackFaceField(words, field), 0u);
+	}
+}
+
+TEST(FaceFormat, FaceDataSettersRoundTrip) {
+	FaceData fresh;
+	for (int corner = 0; corner < faceCornerCount; corner++) {
+		CHECK_EQ((int)fresh.getAO(corner), 0);
+	}
+	CHECK_EQ((int)fresh.getLight(), (int)maxFaceLight);
+
+	for (int x : { 0, 15 }) {
+		for (int z : { 0, 255 }) {
+			for (int d = 0; d < FACE_COUNT; d++) {
+				FaceData face;
+				face.setPosition({ x, 15 - x, z });
+				face.setDirection((BlockFace)d);
+				face.setBlockTexId(GLASS, (BlockFace)d);
+				face.setLight(7);
+				for (int corner = 0; corner < faceCornerCount; corner++) {
+					face.setAO(corner, (uint8_t)corner);
+				}
+
+				CHECK(face.getPosition() == glm::ivec3(x, 15 - x, z));
+				CHECK_EQ((int)face.getDirection(), d);
+				CHECK_EQ(face.getTextureId(), (uint16_t)blockTextureIds[GLASS][d]);
+				CHECK(face.isTranslucent());
+				CHECK_EQ((int)face.getLight(), 7);
+				for (int corner = 0; corner < faceCornerCount; corner++) {
+					CHECK_EQ((int)face.getAO(corner), corner);
+				}
+			}
+		}
+	}
+
+	// clamped rather than spilling into the next field
+	FaceData face;
+	face.setBlockTexId(STONE, TOP);
+	face.setAO(3, 200);
+	face.setLight(200);
+	CHECK_EQ((int)face.getAO(3), (int)maxFaceAO);
+	CHECK_EQ((int)face.getAO(2), 0);
+	CHECK_EQ((int)face.getLight(), (int)maxFaceLight);
+	CHECK(!face.isTranslucent());
+}
+
+TEST(FaceFormat, ShaderGettersMatchTheFields) {
+	std::string glsl = getFaceFormatGlsl();
+
+	for (const FaceField& field : faceFields) {
+		std::string getter = std::string("uint getFace") + field.name + "(uvec2 face) { return (face[" + std::to_string(field.word) + "] >> "
+			+ std::to_string(field.shift) + "u) & " + std::to_string(field.mask()) + "u; }";
+		CHECK(glsl.find(getter) != std::string::npos);
+	}
+}
@@ -0,0 +1,87 @@
+#include "Test.h"
+#include "Frustum.h"
+
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+// from the origin along +x, z up, 90 degrees wide so the side planes are x = |y|
+static Frustum getFrustum() {
+	glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 1.f, 100.f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f));
+	return Frustum::fromViewProjection(proj * view);
+}
+
+TEST(Frustum, BoxesOutsideAnyPlaneAreCulled) {
+	Frustum frustum = getFrustum();
+
+	CHECK(frustum.isBoxVisible({ 10, -1, -1 }, { 12, 1, 1 }));		// ahead
+	CHECK(frustum.isBoxVisible({ 10, 9, -1 }, { 12, 11, 1 }));		// straddling the left plane
+	CHECK(frustum.isBoxVisible({ 95, -1, -1 }, { 105, 1, 1 }));		// straddling the far plane
+	CHECK(!frustum.isBoxVisible({ -12, -1, -1 }, { -10, 1, 1 }));	// behind
+	CHECK(!frustum.isBoxVisible({ 10, 13, -1 }, { 12, 15, 1 }));		// off to the side
+	CHECK(!frustum.isBoxVisible({ 10, -1, 13 }, { 12, 1, 15 }));		// above
+	CHECK(!frustum.isBoxVisible({ 101, -1, -1 }, { 105, 1, 1 }));	// past the far plane
+	CHECK(!frustum.isBoxVisible({ 0.1f, -0.1f, -0.1f }, { 0.5f, 0.1f, 0.1f })); // before the near plane
+}
+
+TEST(Frustum, BoxCullerMatchesTheScalarTest) {
+	Frustum frustum = getFrustum();
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> position(-120.f, 120.f), size(0.5f, 20.f);
+
+	// an odd count, so the last boxes don't fill a group of four
+	BoxCuller culler;
+	std::vector<std::pair<glm::vec3, glm::vec3>> boxes;
+	for (int i = 0; i < 1'003; i++) {
+		glm::vec3 min = { position(rng), position(rng), position(rng) };
+		glm::vec3 max = min + glm::vec3(size(rng), size(rng), size(rng));
+		culler.add(min, max);
+		boxes.push_back({ min, max });
+	}
+
+	std::vector<uint8_t> visible;
+	size_t visibleCount = culler.cull(frustum, visible);
+	CHECK_EQ(visible.size(), boxes.size());
+
+	size_t expectedCount = 0, mismatches = 0;
+	for (size_t i = 0; i < boxes.size(); i++) {
+		bool expected = frustum.isBoxVisible(boxes[i].first, boxes[i].second);
+		expectedCount += expected;
+		mismatches += (visible[i] != (uint8_t)expected);
+	}
+
+	CHECK_EQ(mismatches, (size_t)0);
+	CHECK_EQ(visibleCount, expectedCount);
+	CHECK(visibleCount > 0 && visibleCount < boxes.size());
+}
+
+TEST(Frustum, BoxCullerCanBeRefilled) {
+	Frustum frustum = getFrustum();
+	BoxCuller culler;
+	std::vector<uint8_t> visible;
+
+	culler.add({ 10, -1, -1 }, { 12, 1, 1 });
+	culler.add({ -12, -1, -1 }, { -10, 1, 1 });
+	CHECK_EQ(culler.cull(frustum, visible), (size_t)1);
+	CHECK(visible[0] == 1 && visible[1] == 0);
+
+	culler.clear();
+	CHECK_EQ(culler.size(), (size_t)0);
+	CHECK_EQ(culler.cull(frustum, visible), (size_t)0);
+	CHECK(visible.empty());
+}
+
+TEST(Frustum, FacesPointingAwayFromTheEyeCantBeVisible) {
+	glm::vec3 min = { 10, 0, 0 }, max = { 26, 16, 16 };
+
+	// the eye is past the boxes' -x side, so only the -x faces can face it
+	glm::vec3 eye = { 0, 8, 8 };
+	CHECK(canFacesBeVisible({ -1, 0, 0 }, min, max, eye));
+	CHECK(!canFacesBeVisible({ 1, 0, 0 }, min, max, eye));
+
+	// from inside the box every direction has faces towards the eye
+	eye = { 18, 8, 8 };
+	for (glm::vec3 normal : { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) }) {
+		CHECK(canFacesBeVisible(normal, min, max, eye));
+	}
+}
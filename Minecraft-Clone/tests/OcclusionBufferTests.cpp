@@ -0,0 +1,161 @@
+#include "Test.h"
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+static const glm::vec3 eye = { 0.f, 0.f, 10.f };
+
+// looking along +x, z up
+static glm::mat4 getViewProj(const glm::vec3& target = eye + glm::vec3(1.f, 0.f, 0.f)) {
+	return glm::perspective(glm::radians(70.f), 2.f, 0.1f, 1'000.f) * glm::lookAt(eye, target, glm::vec3(0, 0, 1));
+}
+
+// @returns The point in occlusion buffer pixels, z => 1 / w
+static glm::vec3 project(const glm::mat4& viewProj, const glm::vec3& p) {
+	glm::vec4 clip = viewProj * glm::vec4(p, 1.f);
+	return { (clip.x / clip.w * 0.5f + 0.5f) * OcclusionBuffer::width, (clip.y / clip.w * 0.5f + 0.5f) * OcclusionBuffer::height, 1.f / clip.w };
+}
+
+// @returns The boxes' outline on screen, counter-clockwise
+static std::vector<glm::vec2> getSilhouette(const glm::mat4& viewProj, const glm::vec3& min, const glm::vec3& max) {
+	std::vector<glm::vec2> points;
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+		points.push_back(glm::vec2(project(viewProj, corner)));
+	}
+
+	std::sort(points.begin(), points.end(), [](const glm::vec2& a, const glm::vec2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+
+	auto cross = [](const glm::vec2& o, const glm::vec2& a, const glm::vec2& b) {
+		return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+	};
+
+	// monotone chain, lower then upper hull
+	std::vector<glm::vec2> hull;
+	for (int pass = 0; pass < 2; pass++) {
+		size_t start = hull.size();
+		for (const glm::vec2& p : points) {
+			while (hull.size() >= start + 2 && cross(hull[hull.size() - 2], hull.back(), p) <= 0.f) {
+				hull.pop_back();
+			}
+			hull.push_back(p);
+		}
+
+		hull.pop_back();
+		std::reverse(points.begin(), points.end());
+	}
+
+	return hull;
+}
+
+static bool isInside(const std::vector<glm::vec2>& hull, const glm::vec2& p) {
+	for (size_t i = 0; i < hull.size(); i++) {
+		const glm::vec2& a = hull[i];
+		const glm::vec2& b = hull[(i + 1) % hull.size()];
+		if ((b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x) < -1e-3f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST(OcclusionBuffer, BoxesBehindAWallAreHidden) {
+	OcclusionBuffer buffer;
+	buffer.begin(getViewProj());
+
+	CHECK(buffer.isBoxVisible({ 20, -5, 5 }, { 25, 5, 15 }));
+
+	// a wall across the view, 10 blocks ahead
+	CHECK(buffer.addOccluder({ 10, -20, -20 }, { 12, 20, 40 }, eye));
+
+	CHECK(!buffer.isBoxVisible({ 20, -5, 5 }, { 25, 5, 15 }));	// straight behind
+	CHECK(!buffer.isBoxVisible({ 30, 30, 5 }, { 35, 35, 15 }));	// behind it, off to the side
+	CHECK(!buffer.isBoxVisible({ 12, -1, 9 }, { 13, 1, 11 }));	// touching its back
+}
+
+TEST(OcclusionBuffer, BoxesNotBehindAWallStayVisible) {
+	OcclusionBuffer buffer;
+	buffer.begin(getViewProj());
+	buffer.addOccluder({ 10, -20, -20 }, { 12, 20, 40 }, eye);
+
+	CHECK(buffer.isBoxVisible({ 5, -1, 9 }, { 6, 1, 11 }));			// in front of it
+	CHECK(buffer.isBoxVisible({ 10, -20, -20 }, { 12, 20, 40 }));	// the wall itself
+	CHECK(buffer.isBoxVisible({ 30, 30, 45 }, { 35, 35, 50 }));		// above it
+	CHECK(buffer.isBoxVisible({ -5, -5, 5 }, { -1, 5, 15 }));		// behind the eye
+
+	// a box around the eye can't be rasterized
+	CHECK(!buffer.addOccluder({ -1, -1, 9 }, { 1, 1, 11 }, eye));
+}
+
+TEST(OcclusionBuffer, OccludersOnlyCoverPixelsInsideTheirSilhouette) {
+	// head on, and from an angle where three sides face the eye
+	std::vector<glm::mat4> views = { getViewProj(), getViewProj(eye + glm::vec3(1.f, 0.35f, -0.3f)) };
+	glm::vec3 min = { 20.3f, -3.7f, 6.2f }, max = { 24.9f, 4.1f, 13.6f };
+
+	for (const glm::mat4& viewProj : views) {
+		OcclusionBuffer buffer;
+		buffer.begin(viewProj);
+		CHECK(buffer.addOccluder(min, max, eye));
+
+		std::vector<glm::vec2> silhouette = getSilhouette(viewProj, min, max);
+
+		int covered = 0, fullyInside = 0;
+		for (int y = 0; y < OcclusionBuffer::height; y++) {
+			for (int x = 0; x < OcclusionBuffer::width; x++) {
+				bool inside = true;
+				for (int corner = 0; corner < 4; corner++) {
+					inside = inside && isInside(silhouette, glm::vec2(x + (corner & 1), y + (corner >> 1)));
+				}
+
+				bool written = buffer.getDepth(x, y) > 0.f;
+				CHECK(!written || inside);
+
+				covered += written;
+				fullyInside += inside;
+			}
+		}
+
+		// conservative, but not so much that it stops occluding
+		CHECK(covered > 0);
+		CHECK(covered * 10 >= fullyInside * 9);
+	}
+}
+
+TEST(OcclusionBuffer, HiddenBoxesAreBehindTheBufferAtEveryPoint) {
+	glm::mat4 viewProj = getViewProj();
+	OcclusionBuffer buffer;
+	std::mt19937 rng(3);
+	auto random = [&](int lo, int hi) { return (float)std::uniform_int_distribution<int>(lo, hi)(rng); };
+	auto unit = [&]() { return std::uniform_real_distribution<float>(0.f, 1.f)(rng); };
+
+	int hidden = 0;
+	for (int scene = 0; scene < 500; scene++) {
+		buffer.begin(viewProj);
+		for (int i = 0; i < 5; i++) {
+			glm::vec3 min = { random(3, 42), random(-30, 29), random(-5, 24) };
+			buffer.addOccluder(min, min + glm::vec3(random(1, 10), random(1, 20), random(1, 20)), eye);
+		}
+
+		glm::vec3 min = { random(3, 82), random(-30, 29), random(-5, 24) };
+		glm::vec3 size = { random(1, 5), random(1, 5), random(1, 5) };
+		if (buffer.isBoxVisible(min, min + size)) {
+			continue;
+		}
+
+		hidden++;
+		for (int sample = 0; sample < 100; sample++) {
+			glm::vec3 p = project(viewProj, min + size * glm::vec3(unit(), unit(), unit()));
+			if (p.x < 0.f || p.y < 0.f || p.x >= OcclusionBuffer::width || p.y >= OcclusionBuffer::height) {
+				continue;
+			}
+
+			CHECK(buffer.getDepth((int)p.x, (int)p.y) > p.z);
+		}
+	}
+
+	// or the scenes aren't testing anything
+	CHECK(hidden > 20);
+}
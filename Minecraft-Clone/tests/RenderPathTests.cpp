@@ -0,0 +1,185 @@
+#include "Test.h"
+#include "Chunk.h"
+#include "ChunkManager.h"
+#include "ChunkMeshBuffer.h"
+#include "DeviceUploadRing.h"
+#include "RecordingRenderDevice.h"
+
+#include <chrono>
+#include <thread>
+#include <glm/gtc/matrix_transform.hpp>
+
+static RecordingRenderDevice& getDevice() {
+	static RecordingRenderDevice device;
+	RenderDevice::setInstance(&device);
+	return device;
+}
+
+// Runs the frame's deferred work until 'done' or a few seconds have passed, GL work is run right away
+template <typename Predicate>
+static bool pumpUntil(ChunkManager* manager, Predicate done) {
+	for (int i = 0; i < 1'000; i++) {
+		manager->checkForLoadedChunks();
+		manager->updateChunks();
+		manager->swapMeshes();
+		manager->collectGarbage();
+		manager->getRenderCommands().execute();
+
+		if (done()) {
+			return true;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	return false;
+}
+
+// The singleton, since chunks reach their neighbours through it. Chunks 2 away are meshed at LOD 1,
+// and there is no chunk cache, so nothing can come back out of it.
+static ChunkManager* getLoadedManager() {
+	getDevice();
+
+	ChunkManager* manager = ChunkManager::getInstance();
+	if (manager->chunkCount() == 0) {
+		manager->setLodDistance(2);
+		manager->setCacheBudget(0);
+		manager->initChunks(4);
+		pumpUntil(manager, [&]() { return manager->getMissingChunkCount() == 0 && manager->getPendingUploadCount() == 0; });
+	}
+
+	return manager;
+}
+
+TEST(RenderPath, MeshBufferUploadsAndDrawsThroughTheDevice) {
+	RecordingRenderDevice& device = getDevice();
+
+	RenderCommandList commands;
+	std::vector<FaceData> faces(300);
+	{
+		// the first upload sets up the buffer, only count the faces
+		ChunkMeshBuffer meshBuffer(commands);
+		FaceRange a, b;
+		meshBuffer.upload(a, faces.data(), 0);
+		commands.execute();
+		device.resetStats();
+
+		meshBuffer.upload(a, faces.data(), 100);
+		meshBuffer.upload(b, faces.data(), 300);
+		commands.execute();
+
+		CHECK(a.size >= 100 && b.size >= 300);
+		CHECK(a.offset + a.size <= b.offset || b.offset + b.size <= a.offset);
+		CHECK_EQ(device.getStats().bytesUploaded, 400 * sizeof(FaceData));
+
+		// staged faces are a GPU copy, not another upload
+		DeviceUploadRing ring(1 << 16);
+		UploadRing::RegionId region = 0;
+		size_t offset = 0;
+		CHECK(ring.allocate(50 * sizeof(FaceData), region, offset) != nullptr);
+
+		FaceRange c;
+		meshBuffer.copyFromStaging(c, ring.getBuffer(), offset, 50);
+		commands.execute();
+		CHECK_EQ(device.getStats().bytesCopied, 50 * sizeof(FaceData));
+		CHECK_EQ(device.getStats().bytesUploaded, 400 * sizeof(FaceData));
+		ring.release(region);
+
+		std::vector<DrawArraysIndirectCommand> draws;
+		std::vector<glm::vec4> drawData;
+		buildDrawCommands({ { a, 100 }, { b, 300 }, { c, 50 } }, draws, drawData);
+		meshBuffer.draw(draws, drawData);
+		CHECK_EQ(device.getStats().drawCalls, (size_t)1);
+		CHECK_EQ(device.getStats().drawCommands, (size_t)3);
+
+		meshBuffer.release(a);
+		meshBuffer.release(b);
+		meshBuffer.release(c);
+		commands.execute();
+		CHECK_EQ(meshBuffer.getStats().usedBytes, (size_t)0);
+	}
+
+	// the buffer and the ring gave back everything they made
+	commands.execute();
+	CHECK_EQ(device.getObjectCounts().getTotal(), 0);
+	CHECK_EQ(device.getStats().invalidCalls, (size_t)0);
+}
+
+TEST(RenderPath, ChunkManagerDrawsTheWindowInOneMultiDraw) {
+	ChunkManager* manager = getLoadedManager();
+	RecordingRenderDevice& device = getDevice();
+	CHECK_EQ(manager->chunkCount(), (size_t)49);
+
+	glm::vec3 eye = { 8.f, 8.f, 40.f };
+	glm::mat4 viewProj = glm::perspective(glm::radians(70.f), 4.f / 3.f, 0.1f, 1'000.f) * glm::lookAt(eye, eye + glm::vec3(1.f, 0.3f, -0.4f), glm::vec3(0, 0, 1));
+
+	RenderPacket packet;
+	manager->renderChunks(viewProj, eye, packet);
+	packet.glCommands.execute();
+
+	device.resetStats();
+	size_t stateChangesBefore = device.getStateChanges();
+	packet.meshBuffer->draw(packet.chunkCommands, packet.chunkDrawData);
+
+	DrawStats drawStats = manager->getDrawStats();
+	CHECK(!packet.chunkCommands.empty());
+	CHECK_EQ(packet.chunkCommands.size(), packet.chunkDrawData.size());
+	CHECK_EQ(device.getStats().drawCalls, (size_t)1);
+	CHECK_EQ(device.getStats().drawCommands, packet.chunkCommands.size());
+	CHECK(device.getStats().stateChanges > 0);
+	CHECK_EQ(device.getStateChanges() - stateChangesBefore, device.getStats().stateChanges);
+	CHECK(drawStats.lodChunks > 0);
+	CHECK(drawStats.culledChunks > 0);
+	CHECK_EQ(device.getStats().invalidCalls, (size_t)0);
+
+	// every command draws faces inside the buffer
+	ChunkMeshBufferStats meshStats = manager->getMeshBufferStats();
+	for (const DrawArraysIndirectCommand& command : packet.chunkCommands) {
+		CHECK(command.count == 6 && command.instanceCount > 0);
+		CHECK((command.baseInstance + command.instanceCount) * sizeof(FaceData) <= meshStats.capacityBytes);
+	}
+}
+
+TEST(RenderPath, EditsSurviveALodRoundTripWithoutTheCache) {
+	ChunkManager* manager = getLoadedManager();
+
+	Chunk* edited = manager->getChunkAtIndex({ 0, 0 });
+	CHECK(edited != nullptr && edited->getLod() == 0);
+	if (edited == nullptr) {
+		return;
+	}
+
+	// dig a pit two blocks deep into the surface, away from the chunks' sides
+	int surface = (int)chunkSize.z - 1;
+	while (surface > 0 && edited->getBlockAtIndex({ 5, 5, surface }) == AIR) {
+		surface--;
+	}
+
+	size_t facesBefore = edited->getFaceCount();
+	for (int z : { surface, surface - 1 }) {
+		edited->changeBlockAtIndex({ { 5, 5, z }, AIR });
+	}
+	manager->updateChunks();
+	size_t facesAfterEdit = edited->getFaceCount();
+	CHECK(facesAfterEdit != facesBefore);
+
+	// (0, 0) is 2 chunks from the new center so it's re-meshed at LOD 1, then at LOD 0 once the window moves back
+	auto waitForLod = [&](uint8_t lod) {
+		return pumpUntil(manager, [&]() {
+			Chunk* c = manager->getChunkAtIndex({ 0, 0 });
+			return c != nullptr && c->getLod() == lod && manager->getPendingUploadCount() == 0;
+		});
+	};
+
+	manager->moveRenderWindow({ 2, 0 });
+	CHECK(waitForLod(1));
+	manager->moveRenderWindow({ 0, 0 });
+	CHECK(waitForLod(0));
+
+	// re-meshed from the edited blocks, the pit's walls and floor are still there
+	Chunk* c = manager->getChunkAtIndex({ 0, 0 });
+	CHECK(c != nullptr && c->hasEdits());
+	CHECK(c != nullptr && c->getBlockAtIndex({ 5, 5, surface }) == AIR && c->getBlockAtIndex({ 5, 5, surface - 1 }) == AIR);
+	CHECK_EQ(c != nullptr ? c->getFaceCount() : 0, facesAfterEdit);
+	CHECK_EQ(getDevice().getStats().invalidCalls, (size_t)0);
+}
@@ -0,0 +1,146 @@
+#include "Test.h"
+#include "SectionVisibility.h"
+
+using SectionBlocks = std::bitset<visibilitySectionVolume>;
+
+static size_t blockIndex(int x, int y, int z) {
+	return (size_t)(x + visibilitySectionSize * (y + visibilitySectionSize * z));
+}
+
+static SectionBlocks solidSection() {
+	SectionBlocks blocks;
+	blocks.set();
+	return blocks;
+}
+
+// solid, with a tunnel along x through the middle
+static SectionBlocks tunnelSection() {
+	SectionBlocks blocks = solidSection();
+	for (int x = 0; x < visibilitySectionSize; x++) {
+		blocks[blockIndex(x, 8, 8)] = false;
+	}
+	return blocks;
+}
+
+static bool noFacesConnected(const SectionVisibility& v) {
+	for (int a = 0; a < FACE_COUNT; a++) {
+		for (int b = 0; b < FACE_COUNT; b++) {
+			if (v.isConnected((BlockFace)a, (BlockFace)b)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static const auto everywhere = [](const glm::ivec3&) { return true; };
+
+TEST(SectionVisibility, SolidAndEmptySections) {
+	CHECK(noFacesConnected(SectionVisibility::compute(solidSection())));
+
+	SectionVisibility empty = SectionVisibility::compute(SectionBlocks());
+	CHECK(empty.isConnected(TOP, BOTTOM));
+	CHECK(empty.isConnected(LEFT, BACK));
+}
+
+TEST(SectionVisibility, TunnelsConnectOnlyTheFacesTheyReach) {
+	SectionVisibility straight = SectionVisibility::compute(tunnelSection());
+	CHECK(straight.isConnected(LEFT, RIGHT));
+	CHECK(straight.isConnected(RIGHT, LEFT));
+	CHECK(!straight.isConnected(LEFT, TOP));
+	CHECK(!straight.isConnected(FRONT, BACK));
+
+	// in from the left, turning up to the top
+	SectionBlocks bend = solidSection();
+	for (int x = 0; x <= 8; x++) {
+		bend[blockIndex(x, 8, 8)] = false;
+	}
+	for (int z = 8; z < visibilitySectionSize; z++) {
+		bend[blockIndex(8, 8, z)] = false;
+	}
+
+	SectionVisibility bent = SectionVisibility::compute(bend);
+	CHECK(bent.isConnected(LEFT, TOP));
+	CHECK(!bent.isConnected(LEFT, RIGHT));
+	CHECK(!bent.isConnected(TOP, BOTTOM));
+}
+
+TEST(SectionVisibility, AFloorSeparatesAboveFromBelow) {
+	SectionBlocks floor;
+	for (int x = 0; x < visibilitySectionSize; x++) {
+		for (int y = 0; y < visibilitySectionSize; y++) {
+			floor[blockIndex(x, y, 4)] = true;
+		}
+	}
+
+	SectionVisibility v = SectionVisibility::compute(floor);
+	CHECK(!v.isConnected(TOP, BOTTOM));
+	CHECK(v.isConnected(LEFT, RIGHT));
+	CHECK(v.isConnected(TOP, LEFT));
+	CHECK(v.isConnected(BOTTOM, FRONT));
+}
+
+TEST(SectionVisibility, SearchFollowsACaveThroughSolidRock) {
+	// a row of 5 x 1 x 3 sections, the middle layer is a tunnel along x, the rest solid
+	SectionGraph graph;
+	graph.reset({ 5, 1, 3 });
+
+	SectionVisibility solid = SectionVisibility::compute(solidSection());
+	SectionVisibility tunnel = SectionVisibility::compute(tunnelSection());
+	for (int x = 0; x < 5; x++) {
+		for (int z = 0; z < 3; z++) {
+			graph.setSection({ x, 0, z }, z == 1 ? tunnel : solid);
+		}
+	}
+
+	// the camera's section sees out of every face, the rest only through the tunnel
+	std::vector<uint8_t> visible;
+	size_t count = graph.findVisible({ 0, 0, 1 }, everywhere, visible);
+	CHECK_EQ(count, (size_t)7);
+	CHECK(visible[graph.cellToIndex({ 4, 0, 1 })]);
+	CHECK(visible[graph.cellToIndex({ 0, 0, 2 })]);
+	CHECK(visible[graph.cellToIndex({ 0, 0, 0 })]);
+	CHECK(!visible[graph.cellToIndex({ 1, 0, 2 })]);
+	CHECK(!visible[graph.cellToIndex({ 3, 0, 0 })]);
+
+	// sections out of view aren't entered, so nothing past them is reached either
+	graph.findVisible({ 0, 0, 1 }, [](const glm::ivec3& cell) { return cell.x < 2; }, visible);
+	CHECK(visible[graph.cellToIndex({ 1, 0, 1 })]);
+	CHECK(!visible[graph.cellToIndex({ 2, 0, 1 })]);
+	CHECK(!visible[graph.cellToIndex({ 4, 0, 1 })]);
+}
+
+TEST(SectionVisibility, SearchNeverTurnsBack) {
+	// a U shaped cave: along +x, up, then back along -x above the start
+	SectionGraph graph;
+	graph.reset({ 3, 1, 2 });
+
+	SectionVisibility solid = SectionVisibility::compute(solidSection());
+	SectionVisibility leftRight = SectionVisibility::compute(tunnelSection());
+	SectionVisibility turn;
+	turn.connect(LEFT, TOP);
+	turn.connect(LEFT, BOTTOM);
+
+	graph.setSection({ 0, 0, 0 }, solid);
+	graph.setSection({ 1, 0, 0 }, leftRight);
+	graph.setSection({ 2, 0, 0 }, turn);
+	graph.setSection({ 2, 0, 1 }, turn);
+	graph.setSection({ 1, 0, 1 }, leftRight);
+	graph.setSection({ 0, 0, 1 }, solid);
+
+	// looking from (1, 0, 0) the cave comes back over the camera, which would mean going -x after +x
+	std::vector<uint8_t> visible;
+	graph.findVisible({ 1, 0, 0 }, everywhere, visible);
+	CHECK(visible[graph.cellToIndex({ 2, 0, 0 })]);
+	CHECK(visible[graph.cellToIndex({ 2, 0, 1 })]);
+	CHECK(!visible[graph.cellToIndex({ 0, 0, 1 })]);
+}
+
+TEST(SectionVisibility, OpenWorldIsAllVisible) {
+	SectionGraph graph;
+	graph.reset({ 4, 4, 4 });
+
+	std::vector<uint8_t> visible;
+	CHECK_EQ(graph.findVisible({ 1, 1, 1 }, everywhere, visible), (size_t)64);
+	CHECK_EQ(graph.findVisible({ 9, 9, 9 }, everywhere, visible), (size_t)0);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <iostream>
+#include <vector>
+
+// A test is a function registered under a suite, TestMain.cpp runs the suites named on its command line.
+// Failed CHECKs are reported and counted, the test carries on.
+struct TestCase {
+	const char* suite = "";
+	const char* name = "";
+	void (*func)() = nullptr;
+};
+
+std::vector<TestCase>& getTestCases();
+void reportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar {
+	TestRegistrar(const char* suite, const char* name, void (*func)()) {
+		getTestCases().push_back({ suite, name, func });
+	}
+};
+
+#define TEST(suite, name) \
+	static void suite##_##name(); \
+	static TestRegistrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+	static void suite##_##name()
+
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) { \
+			reportFailure(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		auto a_ = (actual); \
+		auto e_ = (expected); \
+		if (!(a_ == e_)) { \
+			reportFailure(__FILE__, __LINE__, #actual " == " #expected); \
+			std::cout << "\t\tgot " << a_ << ", expected " << e_ << std::endl; \
+		} \
+	} while (0)
@@ -0,0 +1,41 @@
+#include "Test.h"
+#include <cstdlib>
+#include <cstring>
+
+static int failedChecks = 0;
+
+std::vector<TestCase>& getTestCases() {
+	static std::vector<TestCase> cases;
+	return cases;
+}
+
+void reportFailure(const char* file, int line, const char* expression) {
+	std::cout << "\tFAILED " << file << ":" << line << ": " << expression << std::endl;
+	failedChecks++;
+}
+
+// Runs the suites named on the command line, or all of them
+int main(int argc, char** argv) {
+	int ran = 0;
+
+	for (const TestCase& test : getTestCases()) {
+		bool selected = (argc < 2);
+		for (int i = 1; i < argc; i++) {
+			selected = selected || std::strcmp(argv[i], test.suite) == 0;
+		}
+
+		if (!selected) {
+			continue;
+		}
+
+		std::cout << test.suite << "." << test.name << std::endl;
+		test.func();
+		ran++;
+	}
+
+	std::cout << ran << " tests, " << failedChecks << " failed checks" << std::endl;
+
+	// the chunk manager's loading thread is never joined, so skip static destruction
+	std::cout.flush();
+	std::quick_exit(ran > 0 && failedChecks == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
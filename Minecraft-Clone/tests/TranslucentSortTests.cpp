@@ -0,0 +1,91 @@
+#include "Test.h"
+#include "Chunk.h"
+#include "TranslucentSort.h"
+
+#include <random>
+
+static FaceData getFace(const glm::ivec3& position, BlockFace direction) {
+	FaceData face;
+	face.setPosition(position);
+	face.setBlockTexId(GLASS, direction);
+	face.setDirection(direction);
+	return face;
+}
+
+// @returns Squared distance from the eye to the faces' center, blocks are centered on their index
+static float distanceToFace(const FaceData& face, const glm::vec3& eyePos) {
+	glm::vec3 center = glm::vec3(face.getPosition()) + glm::vec3(faceNormals[face.getDirection()]) * 0.5f;
+	glm::vec3 toEye = eyePos - center;
+	return glm::dot(toEye, toEye);
+}
+
+TEST(TranslucentSort, FacesAreSortedFurthestFirst) {
+	std::mt19937 rng(5);
+	std::vector<FaceData> faces;
+	for (int i = 0; i < 500; i++) {
+		glm::ivec3 position = { rng() % 16, rng() % 16, rng() % 64 };
+		faces.push_back(getFace(position, (BlockFace)(rng() % FACE_COUNT)));
+	}
+
+	glm::vec3 eye = { 3.3f, 12.8f, 40.1f };
+	sortFacesBackToFront(faces.data(), (uint32_t)faces.size(), eye, 0);
+
+	size_t outOfOrder = 0;
+	for (size_t i = 1; i < faces.size(); i++) {
+		outOfOrder += distanceToFace(faces[i - 1], eye) < distanceToFace(faces[i], eye);
+	}
+	CHECK_EQ(outOfOrder, (size_t)0);
+}
+
+TEST(TranslucentSort, TheFarSideOfABlockIsDrawnFirst) {
+	// both faces of a pane, then the eye moves through it
+	std::vector<FaceData> faces = { getFace({ 4, 4, 8 }, TOP), getFace({ 4, 4, 8 }, BOTTOM) };
+
+	sortFacesBackToFront(faces.data(), 2, { 4.f, 4.f, 20.f }, 0);
+	CHECK_EQ((int)faces[0].getDirection(), (int)BOTTOM);
+
+	sortFacesBackToFront(faces.data(), 2, { 4.f, 4.f, 2.f }, 0);
+	CHECK_EQ((int)faces[0].getDirection(), (int)TOP);
+}
+
+TEST(TranslucentSort, LodFacesAreSortedInBlocks) {
+	// at LOD 1 these cover blocks 2-3 and 6-7, so the eye is nearer the first and it's drawn last
+	std::vector<FaceData> faces = { getFace({ 1, 0, 0 }, TOP), getFace({ 3, 0, 0 }, TOP) };
+	glm::vec3 eye = { 3.2f, 0.f, 4.f };
+
+	sortFacesBackToFront(faces.data(), 2, eye, 1);
+	CHECK_EQ(faces[0].getPosition().x, 3);
+
+	// read as blocks the order flips
+	sortFacesBackToFront(faces.data(), 2, eye, 0);
+	CHECK_EQ(faces[0].getPosition().x, 1);
+}
+
+TEST(TranslucentSort, DrawsAreSortedFurthestFirst) {
+	std::vector<TranslucentDraw> draws;
+	for (float distance : { 5.f, 300.f, 0.f, 42.f, 42.f, 7.5f }) {
+		TranslucentDraw draw;
+		draw.distance = distance;
+		draws.push_back(draw);
+	}
+
+	sortDrawsBackToFront(draws);
+	for (size_t i = 1; i < draws.size(); i++) {
+		CHECK(draws[i - 1].distance >= draws[i].distance);
+	}
+	CHECK_EQ(draws.front().distance, 300.f);
+}
+
+TEST(TranslucentSort, SortCellOnlyChangesAcrossFacePlanes) {
+	glm::vec3 min = { 0, 0, 16 }, max = { 16, 16, 32 };
+
+	// inside, one cell per block
+	CHECK(getTranslucentSortCell({ 3.2f, 4.9f, 20.5f }, min, max) == glm::ivec3(3, 4, 4));
+	CHECK(getTranslucentSortCell({ 3.2f, 4.9f, 20.5f }, min, max) == getTranslucentSortCell({ 3.8f, 4.1f, 20.9f }, min, max));
+	CHECK(getTranslucentSortCell({ 3.2f, 4.9f, 20.5f }, min, max) != getTranslucentSortCell({ 4.1f, 4.9f, 20.5f }, min, max));
+
+	// outside, moving around without crossing a plane keeps the cell
+	CHECK(getTranslucentSortCell({ -40.f, 8.5f, 100.f }, min, max) == glm::ivec3(-1, 8, 16));
+	CHECK(getTranslucentSortCell({ -40.f, 8.5f, 100.f }, min, max) == getTranslucentSortCell({ -3.f, 8.2f, 40.f }, min, max));
+	CHECK(getTranslucentSortCell({ -40.f, 8.5f, 100.f }, min, max) != unsortedCell);
+}
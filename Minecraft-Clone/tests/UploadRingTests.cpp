@@ -0,0 +1,141 @@
+#include "Test.h"
+#include "UploadRing.h"
+
+#include <mutex>
+#include <thread>
+
+TEST(UploadRing, RegionsComeBackOnceTheirFenceSignals) {
+	CpuUploadRing ring(100);
+	UploadRing::RegionId a, b;
+	size_t offsetA, offsetB;
+	CHECK(ring.allocate(40, a, offsetA) != nullptr);
+	CHECK(ring.allocate(40, b, offsetB) != nullptr);
+	CHECK_EQ(offsetA, (size_t)0);
+	CHECK_EQ(offsetB, (size_t)40);
+
+	// released, but not fenced yet
+	ring.release(a);
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)80);
+
+	// fenced, but the GPU hasn't caught up
+	ring.submit();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)80);
+
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)40);
+}
+
+TEST(UploadRing, AllocationsWrapAroundTheEnd) {
+	CpuUploadRing ring(100);
+	UploadRing::RegionId a, b, c;
+	size_t offsetA, offsetB, offsetC;
+	CHECK(ring.allocate(40, a, offsetA) != nullptr);
+	CHECK(ring.allocate(40, b, offsetB) != nullptr);
+
+	// doesn't fit in the 20 at the end, and the front is still in use
+	CHECK(ring.allocate(30, c, offsetC) == nullptr);
+
+	ring.release(a);
+	ring.submit();
+	ring.signalFences();
+	ring.reclaim();
+
+	// the 20 at the end are skipped over and stay used until b comes back
+	CHECK(ring.allocate(30, c, offsetC) != nullptr);
+	CHECK_EQ(offsetC, (size_t)0);
+	CHECK_EQ(ring.getUsed(), (size_t)90);
+
+	// regions come back in order, c waits on b
+	ring.release(c);
+	ring.submit();
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)90);
+
+	ring.release(b);
+	ring.submit();
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)0);
+}
+
+TEST(UploadRing, ReleasesAfterASubmitWaitForTheNextFence) {
+	CpuUploadRing ring(100);
+	UploadRing::RegionId a, b;
+	size_t offset;
+	CHECK(ring.allocate(50, a, offset) != nullptr);
+	CHECK(ring.allocate(50, b, offset) != nullptr);
+
+	ring.release(a);
+	ring.submit();
+
+	// b isn't covered by the fence submitted before its release
+	ring.release(b);
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)50);
+
+	ring.submit();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)50);
+
+	ring.signalFences();
+	ring.reclaim();
+	CHECK_EQ(ring.getUsed(), (size_t)0);
+
+	// and the ring is usable all the way round again
+	CHECK(ring.allocate(100, a, offset) != nullptr);
+	CHECK_EQ(offset, (size_t)0);
+}
+
+TEST(UploadRing, AllocatingFromManyThreads) {
+	CpuUploadRing ring(1 << 16);
+	std::mutex idMutex;
+	std::vector<UploadRing::RegionId> ids;
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; i++) {
+		threads.emplace_back([&]() {
+			for (int k = 0; k < 2'000; k++) {
+				UploadRing::RegionId id;
+				size_t offset;
+				uint8_t* data = ring.allocate(64, id, offset);
+				if (data != nullptr) {
+					data[0] = 1;
+					std::lock_guard<std::mutex> lock(idMutex);
+					ids.push_back(id);
+				}
+			}
+		});
+	}
+
+	// the fence owner keeps releasing and reclaiming while the others allocate
+	auto releaseAll = [&]() {
+		{
+			std::lock_guard<std::mutex> lock(idMutex);
+			for (UploadRing::RegionId id : ids) {
+				ring.release(id);
+			}
+			ids.clear();
+		}
+
+		ring.submit();
+		ring.signalFences();
+		ring.reclaim();
+	};
+
+	for (int k = 0; k < 200; k++) {
+		releaseAll();
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	releaseAll();
+	CHECK_EQ(ring.getUsed(), (size_t)0);
+}